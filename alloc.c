@@ -25,9 +25,10 @@
 #endif
  
 extern uint32_t _heap_start;
+extern uint32_t _heap_end;
 
 #define MEM_START     (uint32_t)(& _heap_start)              	  	/*定义内存池的首地址*/
-#define MEM_END       0x00001500UL	        			/*定义内存池的尾地址*/
+#define MEM_END       (uint32_t)(& _heap_end)	        			/*定义内存池的尾地址, end of RAM (sections.lds)*/
 
 #define MEM_SIZE         (MEM_END - MEM_START)             /*内存池的大小*/
   
@@ -55,6 +56,14 @@ typedef struct mem_block{                /*定义内存管理块的数据结构*
 #define HEAD_NODE    (MEM_END - BLK_SIZE)/*头内存管理块的地址*/
  
 static signed char  mem_init_flag = -1; /*内存分配系统初始化的标志(-1 未初始化),(1 已初始化)*/
+
+#if defined(MEM_STATS_EN) && (MEM_STATS_EN == 1)
+static struct mem_stats mem_st;
+static uint32_t mem_used_blocks;    /*used blocks, one header each*/
+#define MEM_STAT(x)    x
+#else
+#define MEM_STAT(x)
+#endif
  
 /*
 ********************************************************************************
@@ -117,6 +126,11 @@ void mem_init(void)
     node->mem_sta        =    UNUSED;
     
     mem_init_flag = 1;
+#if defined(MEM_STATS_EN) && (MEM_STATS_EN == 1)
+    mem_used_blocks = 0;
+    memset(&mem_st, 0, sizeof(mem_st));
+    mem_st.peak_heap = BLK_SIZE;
+#endif
 	alloc_printf("初始化完成.\r\n");
 }
  
@@ -132,16 +146,45 @@ void mem_init(void)
 *          失败        返回NULL
 ********************************************************************************
 */
-void *malloc(unsigned nbytes)
+#if defined(MEM_STATS_EN) && (MEM_STATS_EN == 1)
+static void mem_stats_alloc(unsigned nbytes, uint32_t size, void *site)
+{
+    int i;
+
+    mem_st.mallocs++;
+    mem_st.cur_bytes += size;
+    mem_used_blocks++;
+    if(mem_st.cur_bytes > mem_st.peak_bytes)
+        mem_st.peak_bytes = mem_st.cur_bytes;
+    if(mem_st.cur_bytes + (mem_used_blocks + 1) * BLK_SIZE > mem_st.peak_heap)
+        mem_st.peak_heap = mem_st.cur_bytes + (mem_used_blocks + 1) * BLK_SIZE;    /*+1: head node*/
+
+    for(i = 0; i < MEM_SITES; i++)
+    {
+        if(mem_st.sites[i].site == site || mem_st.sites[i].site == NULL)
+        {
+            mem_st.sites[i].site = site;
+            mem_st.sites[i].count++;
+            mem_st.sites[i].bytes += nbytes;
+            return;
+        }
+    }
+    mem_st.site_other++;
+}
+#endif
+
+static void *mem_alloc(unsigned nbytes, void *site)
 {
     unsigned int    suit_size = 0xFFFFFFFFUL;
     mem_block     *head_node=NULL, *tmp_node=NULL, *suit_node=NULL;
+    MEM_STAT(uint32_t walk = 0;)
  
     if(nbytes == 0)
     {
         alloc_printf("参数非法!\r\n");
         return NULL;
     }
+    nbytes = (nbytes + 3) & ~3u;    /*keep every block and header 4-byte aligned: ntt.c loads coefficient pairs as uint32_t*/
     if(mem_init_flag < 0)
     {
         alloc_printf("未初始化,先初始化.\r\n");
@@ -151,6 +194,7 @@ void *malloc(unsigned nbytes)
     head_node = tmp_node = (mem_block *)HEAD_NODE;
     while(1)
     {
+        MEM_STAT(walk++;)
         if(tmp_node->mem_sta == UNUSED)
         {
             if(nbytes <= tmp_node->mem_size && tmp_node->mem_size < suit_size)
@@ -162,8 +206,11 @@ void *malloc(unsigned nbytes)
         tmp_node = tmp_node->nxt_ptr;
         if(tmp_node == head_node)
         {
+            MEM_STAT(mem_st.malloc_walk += walk;)
+            MEM_STAT(if(walk > mem_st.malloc_walk_max) mem_st.malloc_walk_max = walk;)
             if(suit_node == NULL)
             {
+                MEM_STAT(mem_st.failures++;)
                 alloc_printf("NULL\r\n");
                 return NULL;
             }
@@ -174,6 +221,7 @@ void *malloc(unsigned nbytes)
     if(nbytes <= suit_node->mem_size && (nbytes + BLK_SIZE) >= suit_node->mem_size)
     {
         suit_node->mem_sta = USED;
+        MEM_STAT(mem_stats_alloc(nbytes, suit_node->mem_size, site);)
         return suit_node->mem_ptr;
     }
     else    if(suit_node->mem_size > (nbytes + BLK_SIZE))
@@ -190,15 +238,22 @@ void *malloc(unsigned nbytes)
         suit_node->mem_size -= (nbytes + BLK_SIZE);
         suit_node->mem_sta   = UNUSED;
         
+        MEM_STAT(mem_stats_alloc(nbytes, nbytes, site);)
         return tmp_node->mem_ptr;
     }
     else
     {
+        MEM_STAT(mem_st.failures++;)
         alloc_printf("size err!\r\n");
     }
     
     return NULL;
 }
+
+void *malloc(unsigned nbytes)
+{
+    return mem_alloc(nbytes, __builtin_return_address(0));
+}
  
 /*
 ********************************************************************************
@@ -214,6 +269,7 @@ void *malloc(unsigned nbytes)
 void free(void *ap)
 {
     mem_block     *head_node, *tmp_node, *nxt_node;
+    MEM_STAT(uint32_t walk = 0;)
     
     if(ap == NULL)
         return;
@@ -224,11 +280,15 @@ void free(void *ap)
     head_node = tmp_node = (mem_block *)HEAD_NODE;
     while(1)
     {
+        MEM_STAT(walk++;)
         if(tmp_node->mem_ptr == ap)
         {
             if(tmp_node->mem_sta != UNUSED)
             {
                 tmp_node->mem_sta = UNUSED;
+                MEM_STAT(mem_st.frees++;)
+                MEM_STAT(mem_st.cur_bytes -= tmp_node->mem_size;)
+                MEM_STAT(mem_used_blocks--;)
                 break;
             }
             else
@@ -250,6 +310,7 @@ AGAIN:
     head_node = tmp_node = (mem_block *)HEAD_NODE;
     while(1)
     {
+        MEM_STAT(walk++;)
         nxt_node = tmp_node->nxt_ptr;
         if(nxt_node == head_node)
         {
@@ -266,14 +327,64 @@ AGAIN:
         }
         tmp_node = nxt_node;
     }
+    MEM_STAT(mem_st.free_walk += walk;)
+    MEM_STAT(if(walk > mem_st.free_walk_max) mem_st.free_walk_max = walk;)
 }
 
 void *m_malloc(unsigned nbytes)
 {
-    return malloc(nbytes);
+    return mem_alloc(nbytes, __builtin_return_address(0));
 }
  
 void m_free(void *ap)
 {
     free(ap);
-}
\ No newline at end of file
+}
+
+#if defined(MEM_STATS_EN) && (MEM_STATS_EN == 1)
+/*
+********************************************************************************
+*                                   内存统计
+*
+* 描述    : 复制统计计数, 并遍历内存块链表求出最大空闲块, 空闲字节数和空闲块数
+*           (copy the counters and walk the block list for the free space figures)
+*
+* 参数  : st        统计结果
+*
+* 返回  : 无
+********************************************************************************
+*/
+void mem_stats_get(struct mem_stats *st)
+{
+    mem_block     *head_node, *tmp_node;
+
+    *st = mem_st;
+    st->largest_free = 0;
+    st->free_bytes = 0;
+    st->free_blocks = 0;
+    if(mem_init_flag < 0)
+        return;
+    head_node = tmp_node = (mem_block *)HEAD_NODE;
+    do
+    {
+        if(tmp_node->mem_sta == UNUSED)
+        {
+            st->free_blocks++;
+            st->free_bytes += tmp_node->mem_size;
+            if(tmp_node->mem_size > st->largest_free)
+                st->largest_free = tmp_node->mem_size;
+        }
+        tmp_node = tmp_node->nxt_ptr;
+    } while(tmp_node != head_node);
+}
+
+void mem_stats_reset(void)
+{
+    uint32_t cur = mem_st.cur_bytes;
+
+    memset(&mem_st, 0, sizeof(mem_st));
+    mem_st.cur_bytes = cur;
+    mem_st.peak_bytes = cur;
+    mem_st.peak_heap = cur + (mem_used_blocks + 1) * BLK_SIZE;
+}
+#endif
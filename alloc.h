@@ -6,5 +6,40 @@ void  m_free(void *ap);
 int memcmp(uint8_t *str1,uint8_t *str2,int len);
 void * memcpy (void *dest, const void *src, int n);
 void* memset(void* s, int c, size_t n);
+
+#define MEM_SITES 8 // call sites counted one by one, the rest go to site_other
+
+struct mem_site {
+    void        *site;   /* return address of the malloc()/m_malloc() call */
+    uint32_t    count;   /* successful allocations */
+    uint32_t    bytes;   /* bytes requested */
+};
+
+struct mem_stats {
+    uint32_t    cur_bytes;       /* bytes in used blocks, block headers not included */
+    uint32_t    peak_bytes;      /* maximum of cur_bytes */
+    uint32_t    peak_heap;       /* maximum of used bytes + block headers: smallest heap that would have done */
+    uint32_t    largest_free;    /* largest free block, filled in by mem_stats_get() */
+    uint32_t    free_bytes;      /* sum of the free blocks, filled in by mem_stats_get() */
+    uint32_t    free_blocks;     /* number of free blocks (> 1: fragmented), filled in by mem_stats_get() */
+    uint32_t    mallocs;
+    uint32_t    frees;
+    uint32_t    failures;        /* malloc() returned NULL */
+    uint32_t    malloc_walk;     /* blocks walked by malloc(), all calls */
+    uint32_t    malloc_walk_max; /* blocks walked by the worst malloc() call */
+    uint32_t    free_walk;       /* blocks walked by free(), lookup and merge passes, all calls */
+    uint32_t    free_walk_max;
+    uint32_t    site_other;      /* allocations from call sites that did not fit in sites[] */
+    struct mem_site sites[MEM_SITES];
+};
+
+#if defined(MEM_STATS_EN) && (MEM_STATS_EN == 1)
+void mem_stats_get(struct mem_stats *st);
+void mem_stats_reset(void);     /* clear the counters, peaks restart from the current usage */
+void mem_stats_dump(void);      /* firmware.c */
+#else
+#define mem_stats_reset() do { } while (0)
+#define mem_stats_dump() do { } while (0)
+#endif
  
 #endif
\ No newline at end of file
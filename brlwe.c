@@ -15,6 +15,7 @@ BRLWE scheme consists of three main phases: key generation, encryption, and decr
 
 #include "brlwe.h"
 #include "ntt.h"
+#include "trace.h"
 
 /*****************************************************************************/
 /* Definition:                                                        */
@@ -27,6 +28,24 @@ BRLWE scheme consists of three main phases: key generation, encryption, and decr
 //typedef uint8_t *BRLWE_Ring_polynomials ;
 //typedef uint8_t *BRLWE_Ring_polynomials2 ;
 
+//coefficients the encryption functions add to their working buffers for the decompressed pk
+#if (BRLWE_DPK > 0) && (BRLWE_DPK < BRLWE_QBITS)
+#define BRLWE_PK_COEFS BRLWE_N
+#else
+#define BRLWE_PK_COEFS 0
+#endif
+
+//pk as the encryption multiplies it: decompressed into buf (BRLWE_PK_COEFS coefficients)
+//when the public key is compressed (BRLWE_DPK in params.h), pk itself otherwise
+static BRLWE_Ring_polynomials BRLWE_pk_decompress(const BRLWE_Ring_polynomials pk, BRLWE_Ring_polynomials buf) {
+#if BRLWE_PK_COEFS > 0
+	memcpy(buf, pk, BRLWE_N * sizeof(*buf));
+	return BRLWE_Decompress(buf, BRLWE_DPK);
+#else
+	return pk;
+#endif
+};
+
 /*****************************************************************************/
 /* Public functions:                                                        */
 /*****************************************************************************/
@@ -38,22 +57,17 @@ BRLWE_Ring_polynomials BRLWE_init_bin_sampling(BRLWE_Ring_polynomials poly) {
 	int i = 0;
 	int j = 0;
 	
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_INIT_BIN_SAMPLING);
 	
-	uint8_t* str = NULL;
-	str = m_malloc(4);
+	uint8_t str[4];//random number buffer, on the stack so that sampling cannot run out of heap
 	for (i = 0; i < (BRLWE_N>>2) ; i++) {
 		RNG_rand(str);
 		for (j = 0; j < 4 ; j++){
 			poly[(i<<2)+j] = (uint8_t)str[j];
 		};
 	};
-	m_free(str);
 	
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);
-	print("\n Cycles Number for BRLWE_init_bin_sampling = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_INIT_BIN_SAMPLING | TRACE_END);
 	
 	return poly;
 	
@@ -74,8 +88,7 @@ BRLWE_Ring_polynomials BRLWE_init_bin_sampling(BRLWE_Ring_polynomials poly) {
 //rev = 1: str[n] = poly[0]; else: str[0] = poly[0]
 BRLWE_Ring_polynomials BRLWE_init_hex(BRLWE_Ring_polynomials poly, uint8_t* str, int rev) {
 	
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_INIT_HEX);
 	
 	if (rev == 1) {
 		for (int i = 0; i < BRLWE_N; i++)
@@ -86,42 +99,41 @@ BRLWE_Ring_polynomials BRLWE_init_hex(BRLWE_Ring_polynomials poly, uint8_t* str,
 			poly[i] = (uint8_t)(str[i] & (BRLWE_Q - 1));
 	}; 
 	
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);
-	print("\n Cycles Number for BRLWE_init_hex = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_INIT_HEX | TRACE_END);
 	
 	return poly;
 };
 
 //initialize a polynomial with all 0.
 BRLWE_Ring_polynomials BRLWE_init(BRLWE_Ring_polynomials poly) {
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_INIT);
 	for (int i = 0; i < BRLWE_N; i++)
 		poly[i] = (uint8_t)0x00;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);
-	print("\n Cycles Number for BRLWE_init = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_INIT | TRACE_END);
 	return poly;
 };
 
 //Main Function 1: Key Generation
 //a is a global parameter shared by Alice and Bob
 // r1 and r2 are randomly selected binary polynomials, r2 is secret key
-// p = r1 - a * r2, p is public key and would be sent to Bob after Key_Gen
+// p = r1 - a * r2, p is public key and would be sent to Bob after Key_Gen (compressed to BRLWE_DPK bits when set)
+//returns NULL when the working buffers do not fit in the heap, key is then not valid
 BRLWE_Ring_polynomials2 BRLWE_Key_Gen(const BRLWE_Ring_polynomials a, BRLWE_Ring_polynomials2 key) {
 	
 	BRLWE_Ring_polynomials pk = key;//public key
 	BRLWE_Ring_polynomials sk = key+BRLWE_N;//secret key
 	
 	sk = BRLWE_init_bin_sampling(sk);
-	pk = Ring_mul(a, sk, pk);
+	if (Ring_mul(a, sk, pk) == NULL)//pk = a*sk
+		return NULL;
 	
 	int i = 0;
 	int j = 0;
 	
 	uint8_t* str = NULL;
 	str = m_malloc(4);//random number buffer: uint8_t str [4]
+	if (str == NULL)
+		return NULL;
 	for (i = 0; i < BRLWE_N>>2 ; i++) {
 		RNG_rand(str);
 		for (j = 0; j < 4 ; j++){
@@ -129,125 +141,223 @@ BRLWE_Ring_polynomials2 BRLWE_Key_Gen(const BRLWE_Ring_polynomials a, BRLWE_Ring
 		};
 	};
 	m_free(str);
+	
+	BRLWE_Compress(pk, BRLWE_DPK);//no-op unless the public key is compressed (params.h)
 
 	return key;
 };
 
+//c1 = c1 + e2, c2 = c2 + e3 + m_wave: the sampling and encoding part of BRLWE_Encry
+//m holds one 0/1 word per coefficient; when m is NULL the message bits are read from mbits instead
+//(packed, N/8 bytes, bit k of byte i is coefficient 8i+k); str is the 4 byte random number buffer
+//One pass over c1 and c2 without branches: e2 is sampled first into a packed bit stream (the RNG
+//order is unchanged: all of e2, then e3 on the fly), the message bit selects q/2 as a mask, and each
+//coefficient is reduced once at the end
+static void BRLWE_Encry_noise(BRLWE_Ring_polynomials c1, BRLWE_Ring_polynomials c2, const uint8_t* m, const uint8_t* mbits, uint8_t* str) {
+	uint8_t e2[(BRLWE_N + 7) >> 3];
+	uint32_t nibble, bit;
+	int i = 0;
+	int j = 0;
+	int k = 0;
+	
+	for (i = 0; i < BRLWE_N>>2 ; i++) {
+		RNG_rand(str);
+		nibble = str[0] | (str[1] << 1) | (str[2] << 2) | (str[3] << 3);
+		e2[i >> 1] = (i & 1) ? e2[i >> 1] | (nibble << 4) : nibble;
+	};
+	
+	for (i = 0; i < BRLWE_N>>2 ; i++) {
+		RNG_rand(str);
+		for (j = 0; j < 4 ; j++){
+			k = (i<<2)+j;
+			bit = m != NULL ? m[k] != 0 : (mbits[k >> 3] >> (k & 7)) & 1;
+			c1[k] = ( c1[k] + ((e2[k >> 3] >> (k & 7)) & 1) ) & (BRLWE_Q - 1);
+			//   c1 =   c1  +   e2 ;
+			c2[k] = ( c2[k] + str[j] + ((BRLWE_Q >> 1) & -bit) + BRLWE_Q + (BRLWE_N >> 1) - 1 - k ) & (BRLWE_Q - 1);
+			//   c2 =   c2  +   e3   +  m_wave ;
+		};
+	};
+	
+	BRLWE_Compress(c1, BRLWE_DC1);//no-op unless the ciphertext is compressed (params.h)
+	BRLWE_Compress(c2, BRLWE_DC2);
+};
+
 //Main Function 2: Encryption
 //pre-requirement: length(m) = n, m belongs to {0,1}^n;
 //a is a global parameter shared by Alice and Bob, pk is public key and would be sent to Bob after Key_Gen, m is the message to be crypto
 //After receiving pk, Bob uses 3 error(binary) polynomials e1, e2, e3
 //m_wave = encode(m), c1 = a*e1 +e2, c2 = pk*e1 + e3 + m_wave
 //cryptom = [c1,c2] belonging to R_q^2 are cipertext
+//returns NULL when the working buffers do not fit in the heap, cryptom is then not valid
 BRLWE_Ring_polynomials2 BRLWE_Encry(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint8_t* m, BRLWE_Ring_polynomials2 cryptom ) {
 	BRLWE_Ring_polynomials c1 = cryptom;//crypto message 1
 	BRLWE_Ring_polynomials c2 = cryptom + BRLWE_N;//crypto message 2
 	BRLWE_Ring_polynomials e1 = NULL;
 	
-	e1 = m_malloc(BRLWE_N);
+	e1 = m_malloc(BRLWE_N + BRLWE_PK_COEFS);
+	if (e1 == NULL)
+		return NULL;
 	
 	e1 = BRLWE_init_bin_sampling(e1);
 	
 	c1 = Ring_mul(a, e1, c1);//c1 = a*e1
-	c2 = Ring_mul(pk, e1, c2);//c2 = pk*e1
+	c2 = Ring_mul(BRLWE_pk_decompress(pk, e1 + BRLWE_N), e1, c2);//c2 = pk*e1
 	
 	m_free(e1);
 	
-	int i = 0;
-	int j = 0;
-	
 	// uint32_t cycles_now;
 	// __asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
 	// RNG_seed(cycles_now);
 	
 	uint8_t* str = NULL;
 	str = m_malloc(4);//random number buffer: uint8_t str [4]
+	if (str == NULL)
+		return NULL;
 	
-	for (i = 0; i < BRLWE_N>>2 ; i++) {
-		RNG_rand(str);
-		for (j = 0; j < 4 ; j++){
-			c1[(i<<2)+j] = ( c1[(i<<2)+j] + (uint8_t)str[j] ) & (BRLWE_Q - 1);
-			//   c1     =      c1       +          e2    ;
-		};
-	};
-	
-	for (i = 0; i < BRLWE_N>>2 ; i++) {
-		RNG_rand(str);
-		for (j = 0; j < 4 ; j++){
-			c2[(i<<2)+j] = ( c2[(i<<2)+j] + (uint8_t)str[j] ) & (BRLWE_Q - 1);// + (uint8_t)(BRLWE_Q / 2) * (*(m+4*i+j)) + BRLWE_Q + (BRLWE_N / 2) - 1 - (4*i+j);
-			
-			if (m[(i<<2)+j] != 0)
-				c2[(i<<2)+j] = ( c2[(i<<2)+j] + (uint8_t)(BRLWE_Q >> 1) ) & (BRLWE_Q - 1);
-			c2[(i<<2)+j] = ( c2[(i<<2)+j] + BRLWE_Q + (BRLWE_N >> 1) - 1 - ( i << 2 ) - j ) & (BRLWE_Q - 1);
-			//c2=c2+e3+m_wave;                                                    ;
-		};
-	};
+	BRLWE_Encry_noise(c1, c2, m, NULL, str);
 	
 	m_free(str);
 	
 	return cryptom;
 };
 
+//Encryption of k messages to the same pk: out[i] = BRLWE_Encry(a, pk, msgs[i], out[i]),
+//drawing the same samples as k calls of BRLWE_Encry; e1 and the random number buffer are allocated once
+//returns NULL when they do not fit in the heap
+BRLWE_Ring_polynomials2* BRLWE_Encry_batch(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint8_t** msgs, int k, BRLWE_Ring_polynomials2* out) {
+	BRLWE_Ring_polynomials e1 = NULL;
+	uint8_t* str = NULL;
+	
+	BRLWE_Ring_polynomials pkd = NULL;
+	
+	e1 = m_malloc(BRLWE_N + 4 + BRLWE_PK_COEFS);
+	if (e1 == NULL)
+		return NULL;
+	str = e1 + BRLWE_N;//random number buffer: uint8_t str [4]
+	pkd = BRLWE_pk_decompress(pk, str + 4);
+	
+	for (int i = 0; i < k; i++) {
+		BRLWE_Ring_polynomials c1 = out[i];//crypto message 1
+		BRLWE_Ring_polynomials c2 = out[i] + BRLWE_N;//crypto message 2
+		
+		e1 = BRLWE_init_bin_sampling(e1);
+		c1 = Ring_mul(a, e1, c1);//c1 = a*e1
+		c2 = Ring_mul(pkd, e1, c2);//c2 = pk*e1
+		BRLWE_Encry_noise(c1, c2, msgs[i], NULL, str);
+	};
+	
+	m_free(e1);
+	
+	return out;
+};
+
+#if !((BRLWE_DC1 > 0) || (BRLWE_DC2 > 0))
+
+#define BRLWE_DECRY_FUSED 1
+
+//Fused decryption kernel: Decode(c1*r2 + c2) in one pass over the output coefficients, instead of
+//Ring_mul (with its BRLWE_init), Ring_add and BRLWE_Decode over three N byte polynomials.
+//Coefficient k is accumulated in a register: c2[k], plus c1[k-i] for i <= k, minus c1[k-i+N] for i > k
+//(negacyclic wrap), each term masked by r2[i] in {0,1} instead of a branch on the secret key; one
+//reduction at the end (q is a power of two), then the Decode thresholds without branches.
+//out gets one 0/1 byte per coefficient, or the bits packed (bit k of byte k/8) when packed != 0
+static RAMFUNC void BRLWE_Decry_kernel(const uint8_t* c1, const uint8_t* c2, const uint8_t* r2, uint8_t* out, int packed) {
+	TRACE(TRACE_DECRY_KERNEL);
+	uint32_t low_th = BRLWE_Q >> 2;
+	uint32_t hig_th = (BRLWE_Q + (BRLWE_Q << 1)) >> 2;
+	uint32_t acc, bit, byte = 0;
+	const uint8_t* p;
+	int i, k;
+	
+	for (k = 0; k < BRLWE_N; k++) {
+		acc = c2[k];
+		p = c1 + k;
+		for (i = 0; i <= k; i++)
+			acc += *p-- & -(uint32_t)r2[i];
+		p = c1 + BRLWE_N - 1;
+		for (; i < BRLWE_N; i++)
+			acc -= *p-- & -(uint32_t)r2[i];
+		acc &= BRLWE_Q - 1;
+		bit = ((low_th - acc) >> 31) & ((acc - hig_th) >> 31);//low_th < acc < hig_th
+		if (!packed) {
+			out[k] = bit;
+		} else {
+			byte |= bit << (k & 7);
+			if ((k & 7) == 7 || k == BRLWE_N - 1) {
+				out[k >> 3] = byte;
+				byte = 0;
+			}
+		}
+	};
+	TRACE(TRACE_DECRY_KERNEL | TRACE_END);
+};
+
+#endif
+
 //Main Function 3: Decryption
 //output m' = Decode(c1*r2+c2)
-//r2 is secret key
+//r2 is secret key; returns NULL when the working buffers do not fit in the heap
 uint8_t* BRLWE_Decry(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, uint8_t* recoverm) {
-		BRLWE_Ring_polynomials c1 = cryptom;//crypto message 1
-	BRLWE_Ring_polynomials c2 = cryptom + BRLWE_N;//crypto message 2
-	
-	recoverm = Ring_mul(c1, r2, (BRLWE_Ring_polynomials)recoverm);//recoverm = c1*r2
-	recoverm = Ring_add((BRLWE_Ring_polynomials)recoverm, c2, (BRLWE_Ring_polynomials)recoverm);//recoverm = recoverm + c2
-	
-	return BRLWE_Decode(recoverm);
+#if (BRLWE_DC1 > 0) || (BRLWE_DC2 > 0)
+	return BRLWE_Decry_compressed(cryptom, r2, recoverm, BRLWE_DC1, BRLWE_DC2);
+#else
+	BRLWE_Decry_kernel(cryptom, cryptom + BRLWE_N, r2, recoverm, 0);
+	return recoverm;
+#endif
+};
+
+#if defined(BRLWE_DECRY_FUSED)
+
+//Decryption to a packed message: mbits gets N/8 bytes, bit k of byte i is coefficient 8i+k
+uint8_t* BRLWE_Decry_bits(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, uint8_t* mbits) {
+	BRLWE_Decry_kernel(cryptom, cryptom + BRLWE_N, r2, mbits, 1);
+	return mbits;
 };
 
+#endif
+
 //Decode function
 //Decode polynomial m_wave into string m
 uint8_t* BRLWE_Decode(uint8_t* recoverm) {
+	TRACE(TRACE_DECODE);
 	int i = 0;
 	int low_th = BRLWE_Q >> 2;
-	int hig_th = (BRLWE_Q + BRLWE_Q << 1) >> 2;
+	int hig_th = (BRLWE_Q + (BRLWE_Q << 1)) >> 2;
 	for (i = 0; i < BRLWE_N; i++) {
 		if (recoverm[i] > low_th && recoverm[i] < hig_th)
 			recoverm[i] = (uint8_t)1;
 		else
 			recoverm[i] = (uint8_t)0;
 	};
+	TRACE(TRACE_DECODE | TRACE_END);
 	return recoverm;
 };
 
 //return value ans = a + b;
 BRLWE_Ring_polynomials Ring_add(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_RING_ADD);
 	int i = 0;
 	for (i = 0; i < BRLWE_N; i++)
 		ans[i] = (a[i] + b[i]) & (BRLWE_Q - 1);
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);//print("*");
-	print("\n Cycles Number for Ring_add = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_RING_ADD | TRACE_END);
 	return ans;
 };
 
 //return value = a - b;
 BRLWE_Ring_polynomials Ring_sub(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_RING_SUB);
 	int i = 0;
 	for (i = 0; i < BRLWE_N; i++) 
 		ans[i] = (a[i] - b[i]) & (BRLWE_Q - 1);
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);//print("*");
-	print("\n Cycles Number for Ring_sub = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_RING_SUB | TRACE_END);
 	return ans;
 };
 
 //return value = a * b; b is with binary coefficiences
 //i=0 is lsb, i=n-1 is msb
 //most time/area consuming function(by guess) 
-BRLWE_Ring_polynomials Ring_mul(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+RAMFUNC BRLWE_Ring_polynomials Ring_mul(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
+	TRACE(TRACE_RING_MUL);
 	int i = 0;
 	int j = 0;
 	int tmp = 0;
@@ -272,9 +382,7 @@ BRLWE_Ring_polynomials Ring_mul(const BRLWE_Ring_polynomials a, const BRLWE_Ring
 			};
 		};
 	};
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);//print("*");
-	print("\n Cycles Number for Simple_Ring_mul = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_RING_MUL | TRACE_END);
 	return ans;
 };
 
@@ -286,22 +394,17 @@ BRLWE_Ring_polynomials BRLWE_init_bin_sampling(BRLWE_Ring_polynomials poly) {
 	int i = 0;
 	int j = 0;
 	
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_INIT_BIN_SAMPLING);
 	
-	uint8_t* str = NULL;
-	str = m_malloc(4);
+	uint8_t str[4];//random number buffer, on the stack so that sampling cannot run out of heap
 	for (i = 0; i < (BRLWE_N>>1) ; i++) {
 		RNG_rand(str);
 		for (j = 0; j < 2; j++){
 			poly[(i<<1)+j] = (uint16_t)str[j];
 		};
 	};
-	m_free(str);
 	
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);
-	print("\n Cycles Number for BRLWE_init_bin_sampling = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_INIT_BIN_SAMPLING | TRACE_END);
 	
 	return poly;
 	
@@ -322,8 +425,7 @@ BRLWE_Ring_polynomials BRLWE_init_bin_sampling(BRLWE_Ring_polynomials poly) {
 //rev = 1: str[n] = poly[0]; else: str[0] = poly[0]
 BRLWE_Ring_polynomials BRLWE_init_hex(BRLWE_Ring_polynomials poly, uint16_t* str, int rev) {
 	
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_INIT_HEX);
 	
 	if (rev == 1) {
 		for (int i = 0; i < BRLWE_N; i++)
@@ -336,169 +438,327 @@ BRLWE_Ring_polynomials BRLWE_init_hex(BRLWE_Ring_polynomials poly, uint16_t* str
 			//poly[i] = montgomery_reduce(str[i]);
 	}; 
 	
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);
-	print("\n Cycles Number for BRLWE_init_hex = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_INIT_HEX | TRACE_END);
 	
 	return poly;
 };
 
 //initialize a polynomial with all 0.
 BRLWE_Ring_polynomials BRLWE_init(BRLWE_Ring_polynomials poly) {
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_INIT);
 	for (int i = 0; i < BRLWE_N; i++)
 		poly[i] = (uint16_t)0x00;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);
-	print("\n Cycles Number for BRLWE_init = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_INIT | TRACE_END);
 	return poly;
 };
 
 //Main Function 1: Key Generation
 //a is a global parameter shared by Alice and Bob
 // r1 and r2 are randomly selected binary polynomials, r2 is secret key
-// p = r1 - a * r2, p is public key and would be sent to Bob after Key_Gen
+// p = r1 - a * r2, p is public key and would be sent to Bob after Key_Gen (compressed to BRLWE_DPK bits when set)
+//returns NULL when the working buffers do not fit in the heap, key is then not valid
 BRLWE_Ring_polynomials2 BRLWE_Key_Gen(const BRLWE_Ring_polynomials a, BRLWE_Ring_polynomials2 key) {
 	
 	BRLWE_Ring_polynomials pk = key;//public key
 	BRLWE_Ring_polynomials sk = key+BRLWE_N;//secret key
 	
 	sk = BRLWE_init_bin_sampling(sk);
-	pk = Ring_mul(a, sk, pk);
+	if (Ring_mul(a, sk, pk) == NULL)//pk = a*sk
+		return NULL;
 	
 	int i = 0;
 	int j = 0;
 	
 	uint8_t* str = NULL;
 	str = m_malloc(4);//random number buffer: uint8_t str [4]
+	if (str == NULL)
+		return NULL;
 	for (i = 0; i < BRLWE_N>>2 ; i++) {
 		RNG_rand(str);
 		for (j = 0; j < 4 ; j++){
-			pk[(i<<2)+j] = (uint16_t)((uint16_t)str[j] - pk[(i<<2)+j] ) % BRLWE_Q ;
+			pk[(i<<2)+j] = (uint16_t)((uint16_t)str[j] + BRLWE_Q - pk[(i<<2)+j] ) % BRLWE_Q ;
 			//pk[(i<<2)+j] = montgomery_reduce((uint16_t)str[j] - pk[(i<<2)+j] );
 		};
 	};
 	m_free(str);
+	
+	BRLWE_Compress(pk, BRLWE_DPK);//no-op unless the public key is compressed (params.h)
 
 	return key;
 };
 
+//ans = g mod (x^N + 1): folds the 2N coefficient product of the PtNTT back into R_q
+static void ptntt_fold(const uint16_t* g, BRLWE_Ring_polynomials ans) {
+	uint32_t tmp = 0;
+	for (int i = 0; i < BRLWE_N * 2; i++) {
+		if (i < BRLWE_N) {
+			tmp = (uint32_t)g[i];
+			//ans[i] = montgomery_reduce(tmp);
+			ans[i] = (uint16_t)(tmp % BRLWE_Q);
+		}
+		else {
+			tmp = (uint32_t)ans [i - BRLWE_N] + 4 * BRLWE_Q - (uint32_t)g[i];
+			//ans[i - BRLWE_N] = montgomery_reduce(tmp);
+			ans[i - BRLWE_N] = (uint16_t)(tmp % BRLWE_Q);
+		}
+	}
+};
+
+//BRLWE_Encry_noise for q = 7681, same arguments and RNG order as the 8-bit version above
+//q is not a power of two, so & (q - 1) becomes masked conditional subtractions of q:
+//c1 + e2 < 2q takes one, c2 + e3 + m_wave + q + N/2 - 1 - k < 3q (N < q) takes two (2q, then q)
+static void BRLWE_Encry_noise(BRLWE_Ring_polynomials c1, BRLWE_Ring_polynomials c2, const uint16_t* m, const uint8_t* mbits, uint8_t* str) {
+	uint8_t e2[(BRLWE_N + 7) >> 3];
+	uint32_t nibble, bit, x;
+	int i = 0;
+	int j = 0;
+	int k = 0;
+	
+	for (i = 0; i < BRLWE_N>>2 ; i++) {
+		RNG_rand(str);
+		nibble = str[0] | (str[1] << 1) | (str[2] << 2) | (str[3] << 3);
+		e2[i >> 1] = (i & 1) ? e2[i >> 1] | (nibble << 4) : nibble;
+	};
+	
+	for (i = 0; i < BRLWE_N>>2 ; i++) {
+		RNG_rand(str);
+		for (j = 0; j < 4 ; j++){
+			k = (i<<2)+j;
+			bit = m != NULL ? m[k] != 0 : (mbits[k >> 3] >> (k & 7)) & 1;
+			x = c1[k] + ((e2[k >> 3] >> (k & 7)) & 1);//c1 = c1 + e2
+			c1[k] = x - (BRLWE_Q & -(uint32_t)(x >= BRLWE_Q));
+			x = c2[k] + str[j] + ((BRLWE_Q >> 1) & -bit) + BRLWE_Q + (BRLWE_N >> 1) - 1 - k;//c2 = c2 + e3 + m_wave
+			x -= (2 * BRLWE_Q) & -(uint32_t)(x >= 2 * BRLWE_Q);
+			c2[k] = x - (BRLWE_Q & -(uint32_t)(x >= BRLWE_Q));
+		};
+	};
+	
+	BRLWE_Compress(c1, BRLWE_DC1);//no-op unless the ciphertext is compressed (params.h)
+	BRLWE_Compress(c2, BRLWE_DC2);
+};
+
 //Main Function 2: Encryption
 //pre-requirement: length(m) = n, m belongs to {0,1}^n;
 //a is a global parameter shared by Alice and Bob, pk is public key and would be sent to Bob after Key_Gen, m is the message to be crypto
 //After receiving pk, Bob uses 3 error(binary) polynomials e1, e2, e3
 //m_wave = encode(m), c1 = a*e1 +e2, c2 = pk*e1 + e3 + m_wave
 //cryptom = [c1,c2] belonging to R_q^2 are cipertext
+//returns NULL when the working buffers do not fit in the heap, cryptom is then not valid
 BRLWE_Ring_polynomials2 BRLWE_Encry(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint16_t* m, BRLWE_Ring_polynomials2 cryptom ) {
 	BRLWE_Ring_polynomials c1 = cryptom;//crypto message 1
 	BRLWE_Ring_polynomials c2 = cryptom + BRLWE_N;//crypto message 2
 	BRLWE_Ring_polynomials e1 = NULL;
 	
-	e1 = m_malloc(BRLWE_N * 2);
+	e1 = m_malloc((BRLWE_N + BRLWE_PK_COEFS) * 2);
+	if (e1 == NULL)
+		return NULL;
 	
 	e1 = BRLWE_init_bin_sampling(e1);
-	c1 = Ring_mul(a, e1, c1);//c1 = a*e1
-	c2 = Ring_mul(pk, e1, c2);//c2 = pk*e1
+	if (Ring_mul(a, e1, c1) == NULL || Ring_mul(BRLWE_pk_decompress(pk, e1 + BRLWE_N), e1, c2) == NULL) {//c1 = a*e1, c2 = pk*e1
+		m_free(e1);
+		return NULL;
+	}
 
 	m_free(e1);
 	
-	int i = 0;
-	int j = 0;
-	
 	// uint32_t cycles_now;
 	// __asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
 	// RNG_seed(cycles_now);
 	
 	uint8_t* str = NULL;
 	str = m_malloc(4);//random number buffer: uint8_t str [4]
-	for (i = 0; i < BRLWE_N>>2 ; i++) {
-		RNG_rand(str);
-		for (j = 0; j < 4 ; j++){
-			c1[(i<<2)+j] = ( c1[(i<<2)+j] + (uint16_t)str[j] ) % BRLWE_Q;
-			//c1[(i<<2)+j] = montgomery_reduce( c1[(i<<2)+j] + (uint16_t)str[j] );
-			//   c1     =      c1       +          e2    ;
-		};
+	if (str == NULL)
+		return NULL;
+	BRLWE_Encry_noise(c1, c2, m, NULL, str);
+	m_free(str);
+	
+	return cryptom;
+};
+
+//Encryption of k messages to the same pk: out[i] = BRLWE_Encry(a, pk, msgs[i], out[i]),
+//drawing the same samples as k calls of BRLWE_Encry
+//PtNTT: a and pk are transformed once for the whole batch, e1 once per message for both products,
+//and all working buffers come from one allocation; returns NULL when they do not fit in the heap
+BRLWE_Ring_polynomials2* BRLWE_Encry_batch(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint16_t** msgs, int k, BRLWE_Ring_polynomials2* out) {
+#if !(defined(My_NTT) && (My_NTT == 1)) && defined(PtNTT) && (PtNTT == 1) && defined(PTNTT_INPLACE) && (PTNTT_INPLACE == 1)
+	uint16_t* fa = NULL;
+	uint16_t* fpk = NULL;
+	uint16_t* ge = NULL;
+	uint16_t* buf = NULL;
+	uint8_t* str = NULL;
+	
+	//a, pk and e1 transformed, a product buffer (N each) and the random number buffer
+	fa = (uint16_t*)m_malloc((4 * BRLWE_N + 2) * sizeof(uint16_t));
+	if (fa == NULL)
+		return NULL;
+	fpk = fa + BRLWE_N;
+	ge = fpk + BRLWE_N;
+	buf = ge + BRLWE_N;
+	str = (uint8_t*)(buf + BRLWE_N);
+	
+	//one-time setup: forward transforms of a and pk (decompressed in buf first when it is compressed)
+	poly_pt_ntt_split(fa, a);
+	poly_pt_ntt_split(fpk, BRLWE_pk_decompress(pk, buf));
+	
+	for (int i = 0; i < k; i++) {
+		BRLWE_Ring_polynomials c1 = out[i];//crypto message 1
+		BRLWE_Ring_polynomials c2 = out[i] + BRLWE_N;//crypto message 2
+		
+		BRLWE_init_bin_sampling(buf);//e1
+		poly_pt_ntt_split(ge, buf);
+		
+		pt_ntt_basemul(buf, fa, ge);
+		poly_inv_pt_ntt_split(c1, buf);//c1 = a*e1
+		
+		pt_ntt_basemul(buf, fpk, ge);
+		poly_inv_pt_ntt_split(c2, buf);//c2 = pk*e1
+		
+		BRLWE_Encry_noise(c1, c2, msgs[i], NULL, str);
 	};
 	
-	for (i = 0; i < BRLWE_N>>2 ; i++) {
-		RNG_rand(str);
-		for (j = 0; j < 4 ; j++){
-			c2[(i<<2)+j] = ( c2[(i<<2)+j] + (uint16_t)str[j] ) % BRLWE_Q ;// + (uint8_t)(BRLWE_Q / 2) * (*(m+4*i+j)) + BRLWE_Q + (BRLWE_N / 2) - 1 - (4*i+j);
-			//c2[(i<<2)+j] = montgomery_reduce( c2[(i<<2)+j] + (uint16_t)str[j] );
-			if (m[(i<<2)+j] != 0)
-				c2[(i<<2)+j] = ( c2[(i<<2)+j] + (uint16_t)(BRLWE_Q >> 1) ) % BRLWE_Q;
-				//c2[(i<<2)+j] = montgomery_reduce( c2[(i<<2)+j] + (uint16_t)(BRLWE_Q >> 1) );
-			c2[(i<<2)+j] = ( c2[(i<<2)+j] + BRLWE_Q + (BRLWE_N >> 1) - 1 - ( i << 2 ) - j ) % BRLWE_Q;
-			//c2[(i<<2)+j] = montgomery_reduce( c2[(i<<2)+j] + BRLWE_Q + (BRLWE_N >> 1) - 1 - ( i << 2 ) - j );
-			//c2=c2+e3+m_wave;                                                    ;
-		};
+	m_free(fa);
+#elif !(defined(My_NTT) && (My_NTT == 1)) && defined(PtNTT) && (PtNTT == 1)
+	struct ptpoly4 fa, fpk;
+	struct ptpoly7 ge;
+	uint16_t* pool = NULL;
+	uint16_t* buf = NULL;
+	uint8_t* str = NULL;
+	
+	//15 quarter polynomials (N/2), a 2N product buffer and the random number buffer
+	pool = (uint16_t*)m_malloc((15 * (BRLWE_N / 2) + 2 * BRLWE_N + 2) * sizeof(uint16_t));
+	if (pool == NULL)
+		return NULL;
+	fa.poly00 = pool;
+	fa.poly01 = fa.poly00 + BRLWE_N / 2;
+	fa.poly10 = fa.poly01 + BRLWE_N / 2;
+	fa.poly11 = fa.poly10 + BRLWE_N / 2;
+	fpk.poly00 = fa.poly11 + BRLWE_N / 2;
+	fpk.poly01 = fpk.poly00 + BRLWE_N / 2;
+	fpk.poly10 = fpk.poly01 + BRLWE_N / 2;
+	fpk.poly11 = fpk.poly10 + BRLWE_N / 2;
+	ge.poly4.poly00 = fpk.poly11 + BRLWE_N / 2;
+	ge.poly4.poly01 = ge.poly4.poly00 + BRLWE_N / 2;
+	ge.poly4.poly10 = ge.poly4.poly01 + BRLWE_N / 2;
+	ge.poly4.poly11 = ge.poly4.poly10 + BRLWE_N / 2;
+	ge.poly01_s = ge.poly4.poly11 + BRLWE_N / 2;
+	ge.poly10_s = ge.poly01_s + BRLWE_N / 2;
+	ge.poly11_s = ge.poly10_s + BRLWE_N / 2;
+	buf = ge.poly11_s + BRLWE_N / 2;
+	str = (uint8_t*)(buf + 2 * BRLWE_N);
+	
+	//one-time setup: forward transforms of a and pk (decompressed in buf first when it is compressed)
+	get_int16_polys(buf, a);
+	poly_pt_ntt4(buf, fa);
+	get_int16_polys(buf, BRLWE_pk_decompress(pk, buf));
+	poly_pt_ntt4(buf, fpk);
+	
+	for (int i = 0; i < k; i++) {
+		BRLWE_Ring_polynomials c1 = out[i];//crypto message 1
+		BRLWE_Ring_polynomials c2 = out[i] + BRLWE_N;//crypto message 2
+		
+		BRLWE_init_bin_sampling(buf);//e1
+		get_int16_polys(buf, buf);
+		poly_pt_ntt7(buf, ge);
+		
+		pt_ntt_bowtiemultiply(buf, fa, ge);
+		poly_inv_ptntt(buf);
+		ptntt_fold(buf, c1);//c1 = a*e1
+		
+		pt_ntt_bowtiemultiply(buf, fpk, ge);
+		poly_inv_ptntt(buf);
+		ptntt_fold(buf, c2);//c2 = pk*e1
+		
+		BRLWE_Encry_noise(c1, c2, msgs[i], NULL, str);
 	};
-	m_free(str);
 	
-	return cryptom;
+	m_free(pool);
+#else
+	BRLWE_Ring_polynomials e1 = NULL;
+	BRLWE_Ring_polynomials pkd = NULL;
+	uint8_t* str = NULL;
+	
+	e1 = m_malloc((BRLWE_N + 2 + BRLWE_PK_COEFS) * 2);
+	if (e1 == NULL)
+		return NULL;
+	str = (uint8_t*)(e1 + BRLWE_N);//random number buffer: uint8_t str [4]
+	pkd = BRLWE_pk_decompress(pk, e1 + BRLWE_N + 2);
+	
+	for (int i = 0; i < k; i++) {
+		BRLWE_Ring_polynomials c1 = out[i];//crypto message 1
+		BRLWE_Ring_polynomials c2 = out[i] + BRLWE_N;//crypto message 2
+		
+		e1 = BRLWE_init_bin_sampling(e1);
+		c1 = Ring_mul(a, e1, c1);//c1 = a*e1
+		c2 = Ring_mul(pkd, e1, c2);//c2 = pk*e1
+		BRLWE_Encry_noise(c1, c2, msgs[i], NULL, str);
+	};
+	
+	m_free(e1);
+#endif
+	
+	return out;
 };
 
 //Main Function 3: Decryption
 //output m' = Decode(c1*r2+c2)
-//r2 is secret key
+//r2 is secret key; returns NULL when the working buffers do not fit in the heap
 uint16_t* BRLWE_Decry(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, uint16_t* recoverm) {
+#if (BRLWE_DC1 > 0) || (BRLWE_DC2 > 0)
+	return BRLWE_Decry_compressed(cryptom, r2, recoverm, BRLWE_DC1, BRLWE_DC2);
+#else
 		BRLWE_Ring_polynomials c1 = cryptom;//crypto message 1
 	BRLWE_Ring_polynomials c2 = cryptom + BRLWE_N;//crypto message 2
 	
-	recoverm = Ring_mul(c1, r2, (BRLWE_Ring_polynomials)recoverm);//recoverm = c1*r2
+	if (Ring_mul(c1, r2, (BRLWE_Ring_polynomials)recoverm) == NULL)//recoverm = c1*r2
+		return NULL;
 	recoverm = Ring_add((BRLWE_Ring_polynomials)recoverm, c2, (BRLWE_Ring_polynomials)recoverm);//recoverm = recoverm + c2
 	
 	return BRLWE_Decode(recoverm);
+#endif
 };
 
 //Decode function
 //Decode polynomial m_wave into string m
 uint16_t* BRLWE_Decode(uint16_t* recoverm) {
+	TRACE(TRACE_DECODE);
 	int i = 0;
 	int low_th = BRLWE_Q >> 2;
-	int hig_th = (BRLWE_Q + BRLWE_Q << 1) >> 2;
+	int hig_th = (BRLWE_Q + (BRLWE_Q << 1)) >> 2;
 	for (i = 0; i < BRLWE_N; i++) {
 		if (recoverm[i] > low_th && recoverm[i] < hig_th)
 			recoverm[i] = (uint16_t)1;
 		else
 			recoverm[i] = (uint16_t)0;
 	};
+	TRACE(TRACE_DECODE | TRACE_END);
 	return recoverm;
 };
 
 //return value ans = a + b;
 BRLWE_Ring_polynomials Ring_add(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_RING_ADD);
 	int i = 0;
 	for (i = 0; i < BRLWE_N; i++)
 		ans[i] = (a[i] + b[i]) % BRLWE_Q;
 		//ans[i] = montgomery_reduce(a[i] + b[i]);
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);//print("*");
-	print("\n Cycles Number for Ring_add = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_RING_ADD | TRACE_END);
 	return ans;
 };
 
 //return value = a - b;
 BRLWE_Ring_polynomials Ring_sub(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_RING_SUB);
 	int i = 0;
 	for (i = 0; i < BRLWE_N; i++) 
 		//ans[i] = montgomery_reduce(a[i] + 4 * BRLWE_Q - b[i]);
 		ans[i] = (a[i] + 4 * BRLWE_Q - b[i]) % BRLWE_Q;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);//print("*");
-	print("\n Cycles Number for Ring_sub = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_RING_SUB | TRACE_END);
 	return ans;
 };
 
 BRLWE_Ring_polynomials Simple_Ring_mul_PtNTT(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
 	
-	uint32_t cycles_begin, cycles_now;
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+	TRACE(TRACE_RING_MUL);
 	
 	uint16_t* f = NULL;
 	uint16_t* g = NULL;
@@ -562,25 +822,44 @@ BRLWE_Ring_polynomials Simple_Ring_mul_PtNTT(const BRLWE_Ring_polynomials a, con
 
 	poly_inv_ptntt(g);
 
-	uint32_t tmp = 0;
-	for (int i = 0; i < BRLWE_N * 2; i++) {
-		if (i < BRLWE_N) {
-			tmp = (uint32_t)g[i];
-			//ans[i] = montgomery_reduce(tmp);
-			ans[i] = (uint16_t)(tmp % BRLWE_Q);
-		}
-		else {
-			tmp = (uint32_t)ans [i - BRLWE_N] + 4 * BRLWE_Q - (uint32_t)g[i];
-			//ans[i - BRLWE_N] = montgomery_reduce(tmp);
-			ans[i - BRLWE_N] = (uint16_t)(tmp % BRLWE_Q);
-		}
-	}
+	ptntt_fold(g, ans);
 	
 	m_free(g);
 	
-	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
-	// print("\t| ");print_dec(cycles_now - cycles_begin);//print("*");
-	print("\n Cycles Number for Simple_Ring_mul_PtNTT = ");print_dec(cycles_now - cycles_begin);
+	TRACE(TRACE_RING_MUL | TRACE_END);
+	return ans;
+};
+
+//ans = a * b with the in-place PtNTT of ntt.c (PTNTT_INPLACE, PTNTT_SPLIT lanes): no zero padded copies and no fold,
+//a is transformed in ans itself and b in one N coefficient buffer that also takes the product;
+//ans may be a or b, but not both; returns NULL when the buffer cannot be allocated
+BRLWE_Ring_polynomials Simple_Ring_mul_PtNTT_inplace(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials b, BRLWE_Ring_polynomials ans) {
+	
+	TRACE(TRACE_RING_MUL);
+	
+	const uint16_t* f = a;
+	const uint16_t* g = b;
+	uint16_t* s = NULL;
+	
+	if (ans == f) {//b is read before ans is written
+		f = b;
+		g = a;
+	}
+	
+	s = (uint16_t*)m_malloc(BRLWE_N * sizeof(uint16_t));
+	if (s == NULL) {
+		TRACE(TRACE_RING_MUL | TRACE_END);
+		return NULL;
+	}
+	
+	poly_pt_ntt_split(s, g);
+	poly_pt_ntt_split(ans, f);
+	pt_ntt_basemul(s, ans, s);
+	poly_inv_pt_ntt_split(ans, s);
+	
+	m_free(s);
+	
+	TRACE(TRACE_RING_MUL | TRACE_END);
 	return ans;
 };
 
@@ -592,10 +871,256 @@ BRLWE_Ring_polynomials Ring_mul(const BRLWE_Ring_polynomials a, const BRLWE_Ring
 #else
 	#if defined(My_NTT) && (My_NTT == 1)
 	return Simple_Ring_mul_NBNTT(a, b, ans);
+	#elif defined(PtNTT) && (PtNTT == 1) && defined(PTNTT_INPLACE) && (PTNTT_INPLACE == 1)
+	return Simple_Ring_mul_PtNTT_inplace(a, b, ans);
 	#elif defined(PtNTT) && (PtNTT == 1)
 	return Simple_Ring_mul_PtNTT(a, b, ans);
 	#endif 
 #endif
 };
 
-#endif
\ No newline at end of file
+#endif
+
+/*****************************************************************************/
+/* Compression:                                                              */
+/*****************************************************************************/
+
+//Lossy compression of a polynomial in place, Kyber style: x -> round(2^d / q * x) mod 2^d,
+//d bits per coefficient; d = 0 or d >= BRLWE_QBITS leaves poly unchanged
+BRLWE_Ring_polynomials BRLWE_Compress(BRLWE_Ring_polynomials poly, int d) {
+	if (d <= 0 || d >= BRLWE_QBITS)
+		return poly;
+	for (int i = 0; i < BRLWE_N; i++)
+		poly[i] = (((uint32_t)poly[i] << d) + (BRLWE_Q >> 1)) / BRLWE_Q & ((1u << d) - 1);
+	return poly;
+};
+
+//Inverse of BRLWE_Compress, in place: y -> round(q / 2^d * y)
+BRLWE_Ring_polynomials BRLWE_Decompress(BRLWE_Ring_polynomials poly, int d) {
+	if (d <= 0 || d >= BRLWE_QBITS)
+		return poly;
+	for (int i = 0; i < BRLWE_N; i++)
+		poly[i] = ((uint32_t)poly[i] * BRLWE_Q + (1u << (d - 1))) >> d;
+	return poly;
+};
+
+//BRLWE_Decry of a ciphertext with c1 compressed to d1 and c2 to d2 bits (0: not compressed)
+//cryptom is left as it is; needs one polynomial of heap, returns NULL when it (or the multiply's buffer) cannot be allocated
+BRLWE_Ring_polynomials BRLWE_Decry_compressed(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, BRLWE_Ring_polynomials recoverm, int d1, int d2) {
+	BRLWE_Ring_polynomials c = NULL;
+	
+	c = m_malloc(BRLWE_N * sizeof(*c));
+	if (c == NULL)
+		return NULL;
+	memcpy(c, cryptom, BRLWE_N * sizeof(*c));
+	BRLWE_Decompress(c, d1);
+	if (Ring_mul(c, r2, recoverm) == NULL) {//recoverm = c1*r2
+		m_free(c);
+		return NULL;
+	}
+	memcpy(c, cryptom + BRLWE_N, BRLWE_N * sizeof(*c));
+	BRLWE_Decompress(c, d2);
+	recoverm = Ring_add(recoverm, c, recoverm);//recoverm = recoverm + c2
+	m_free(c);
+	
+	return BRLWE_Decode(recoverm);
+};
+
+/*****************************************************************************/
+/* Wire format:                                                              */
+/*****************************************************************************/
+
+//pack n coefficients of bits bits each into bytes, LSB first; returns the number of bytes
+//dst may be the same buffer as src: byte k of the output is only written after coefficient
+//8k/bits has been read, so the output never overtakes the input
+uint32_t BRLWE_Pack(uint8_t* dst, const BRLWE_Ring_polynomials src, int n, int bits) {
+	uint32_t acc = 0;//bits not written yet
+	int nacc = 0;
+	uint32_t len = 0;
+	for (int i = 0; i < n; i++) {
+		acc |= (uint32_t)src[i] << nacc;
+		nacc += bits;
+		while (nacc >= 8) {
+			dst[len++] = (uint8_t)acc;
+			acc >>= 8;
+			nacc -= 8;
+		}
+	}
+	if (nacc > 0)
+		dst[len++] = (uint8_t)acc;
+	return len;
+};
+
+//inverse of BRLWE_Pack; runs from the last coefficient down, so dst may be the same buffer as src
+void BRLWE_Unpack(BRLWE_Ring_polynomials dst, const uint8_t* src, int n, int bits) {
+	uint32_t pos, acc;
+	for (int i = n - 1; i >= 0; i--) {
+		pos = (uint32_t)i * bits;
+		acc = src[pos >> 3];
+		if ((pos & 7) + bits > 8)
+			acc |= (uint32_t)src[(pos >> 3) + 1] << 8;
+		if ((pos & 7) + bits > 16)
+			acc |= (uint32_t)src[(pos >> 3) + 2] << 16;
+		dst[i] = (acc >> (pos & 7)) & ((1u << bits) - 1);
+	}
+};
+
+static int BRLWE_wire_bits(int type, int half) {
+	if (type == BRLWE_WIRE_SK)
+		return 1;
+	if (type == BRLWE_WIRE_PK && BRLWE_DPK > 0 && BRLWE_DPK < BRLWE_QBITS)
+		return BRLWE_DPK;
+	if (type == BRLWE_WIRE_CT && half == 0 && BRLWE_DC1 > 0 && BRLWE_DC1 < BRLWE_QBITS)
+		return BRLWE_DC1;
+	if (type == BRLWE_WIRE_CT && half == 1 && BRLWE_DC2 > 0 && BRLWE_DC2 < BRLWE_QBITS)
+		return BRLWE_DC2;
+	return BRLWE_QBITS;
+};
+
+//fill in hdr and pack poly (a pk, sk or [c1,c2] ciphertext) in place; returns the number of packed bytes,
+//which follow the header on the wire
+uint32_t BRLWE_Serialize(struct brlwe_wire_hdr* hdr, int type, BRLWE_Ring_polynomials poly) {
+	int b1 = BRLWE_wire_bits(type, 0);
+	int b2 = BRLWE_wire_bits(type, 1);
+	uint32_t len;
+	
+	hdr->magic = BRLWE_WIRE_MAGIC;
+	hdr->set = BRLWE_SET;
+	hdr->type = type;
+	hdr->bits = type == BRLWE_WIRE_CT ? (b1 | (b2 << 4)) : b1;
+	
+	len = BRLWE_Pack((uint8_t*)poly, poly, BRLWE_N, b1);
+	if (type == BRLWE_WIRE_CT)
+		len += BRLWE_Pack((uint8_t*)poly + len, poly + BRLWE_N, BRLWE_N, b2);
+	return len;
+};
+
+//unpack a buffer received after hdr in place; returns 0 when hdr does not match this build
+int BRLWE_Deserialize(const struct brlwe_wire_hdr* hdr, BRLWE_Ring_polynomials poly) {
+	int b1 = BRLWE_wire_bits(hdr->type, 0);
+	int b2 = BRLWE_wire_bits(hdr->type, 1);
+	
+	if (hdr->magic != BRLWE_WIRE_MAGIC || hdr->set != BRLWE_SET || hdr->type < BRLWE_WIRE_PK || hdr->type > BRLWE_WIRE_CT)
+		return 0;
+	if (hdr->bits != (hdr->type == BRLWE_WIRE_CT ? (b1 | (b2 << 4)) : b1))
+		return 0;
+	
+	if (hdr->type == BRLWE_WIRE_CT)//c2 first, its bytes lie behind those of c1
+		BRLWE_Unpack(poly + BRLWE_N, (uint8_t*)poly + ((BRLWE_N * b1 + 7) >> 3), BRLWE_N, b2);
+	BRLWE_Unpack(poly, (uint8_t*)poly, BRLWE_N, b1);
+	return 1;
+};
+
+/*****************************************************************************/
+/* Byte stream encryption:                                                   */
+/*****************************************************************************/
+
+//Encryption of a packed message: mbits holds N/8 bytes, bit k of byte i is coefficient 8i+k
+//same as BRLWE_Encry otherwise, without unpacking the message into N words; returns NULL when the
+//working buffers do not fit in the heap, cryptom is then not valid
+BRLWE_Ring_polynomials2 BRLWE_Encry_bits(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, const uint8_t* mbits, BRLWE_Ring_polynomials2 cryptom) {
+	BRLWE_Ring_polynomials c1 = cryptom;//crypto message 1
+	BRLWE_Ring_polynomials c2 = cryptom + BRLWE_N;//crypto message 2
+	BRLWE_Ring_polynomials e1 = NULL;
+	uint8_t* str = NULL;
+	
+	e1 = m_malloc((BRLWE_N + BRLWE_PK_COEFS) * sizeof(*e1));
+	if (e1 == NULL)
+		return NULL;
+	e1 = BRLWE_init_bin_sampling(e1);
+	if (Ring_mul(a, e1, c1) == NULL || Ring_mul(BRLWE_pk_decompress(pk, e1 + BRLWE_N), e1, c2) == NULL) {//c1 = a*e1, c2 = pk*e1
+		m_free(e1);
+		return NULL;
+	}
+	m_free(e1);
+	
+	str = m_malloc(4);//random number buffer: uint8_t str [4]
+	if (str == NULL)
+		return NULL;
+	BRLWE_Encry_noise(c1, c2, NULL, mbits, str);
+	m_free(str);
+	
+	return cryptom;
+};
+
+#if !defined(BRLWE_DECRY_FUSED)
+
+//Decryption to a packed message: mbits gets N/8 bytes, bit k of byte i is coefficient 8i+k
+//(BRLWE_Decry into a temporary polynomial, then packed); returns NULL when it does not fit in the heap
+uint8_t* BRLWE_Decry_bits(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, uint8_t* mbits) {
+	BRLWE_Ring_polynomials recoverm = m_malloc(BRLWE_N * sizeof(*recoverm));
+	
+	if (recoverm == NULL)
+		return NULL;
+	if (BRLWE_Decry(cryptom, r2, recoverm) == NULL) {
+		m_free(recoverm);
+		return NULL;
+	}
+	BRLWE_Pack(mbits, recoverm, BRLWE_N, 1);
+	m_free(recoverm);
+	
+	return mbits;
+};
+
+#endif
+
+//encrypt the collected block and hand it over; once a block fails, nothing more is emitted
+static void BRLWE_Stream_block(struct brlwe_stream* st) {
+	st->fill = 0;
+	if (st->error || BRLWE_Encry_bits(st->a, st->pk, st->block, st->cryptom) == NULL) {
+		st->error = 1;
+		return;
+	}
+	st->emit(st->ctx, st->cryptom);
+	st->blocks++;
+};
+
+//start a stream to pk; emit(ctx, cryptom) is called with every ciphertext block ([c1,c2], valid until it returns)
+//RAM: one ciphertext and one N/8 byte block for the whole stream; returns 0 when they do not fit in the heap
+int BRLWE_Stream_init(struct brlwe_stream* st, const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, void (*emit)(void* ctx, const BRLWE_Ring_polynomials2 cryptom), void* ctx) {
+	st->a = a;
+	st->pk = pk;
+	st->emit = emit;
+	st->ctx = ctx;
+	st->cryptom = m_malloc(BRLWE_N * 2 * sizeof(*st->cryptom) + BRLWE_N / 8);
+	if (st->cryptom == NULL)
+		return 0;
+	st->block = (uint8_t*)(st->cryptom + BRLWE_N * 2);
+	st->fill = 0;
+	st->blocks = 0;
+	st->bytes = 0;
+	st->error = 0;
+	return 1;
+};
+
+//add len bytes to the stream; every complete N bit block is encrypted and emitted right away
+//returns 0 when a block of the stream could not be encrypted (out of heap, st->error)
+int BRLWE_Stream_update(struct brlwe_stream* st, const uint8_t* data, uint32_t len) {
+	uint32_t n;
+	while (len > 0) {
+		n = BRLWE_N / 8 - st->fill;
+		if (n > len)
+			n = len;
+		memcpy(st->block + st->fill, data, n);
+		st->fill += n;
+		st->bytes += n;
+		data += n;
+		len -= n;
+		if (st->fill == BRLWE_N / 8)
+			BRLWE_Stream_block(st);
+	};
+	return !st->error;
+};
+
+//encrypt the last partial block, padded with zero bits, and release the buffers
+//returns the number of ciphertext blocks emitted; st->bytes holds the stream length for the receiver,
+//st->error is set when the stream is incomplete: a block ran out of heap and nothing followed it
+uint32_t BRLWE_Stream_final(struct brlwe_stream* st) {
+	if (st->fill > 0) {
+		memset(st->block + st->fill, 0, BRLWE_N / 8 - st->fill);
+		BRLWE_Stream_block(st);
+	};
+	m_free(st->cryptom);
+	st->cryptom = NULL;
+	return st->blocks;
+};
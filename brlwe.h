@@ -24,6 +24,7 @@ BRLWE_Ring_polynomials BRLWE_init_hex(BRLWE_Ring_polynomials poly, uint8_t* str,
 BRLWE_Ring_polynomials BRLWE_init(BRLWE_Ring_polynomials poly);//initialize a polynomial with all 0.
 BRLWE_Ring_polynomials2 BRLWE_Key_Gen(const BRLWE_Ring_polynomials a, BRLWE_Ring_polynomials2 key);
 BRLWE_Ring_polynomials2 BRLWE_Encry(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint8_t* m, BRLWE_Ring_polynomials2 cryptom );
+BRLWE_Ring_polynomials2* BRLWE_Encry_batch(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint8_t** msgs, int k, BRLWE_Ring_polynomials2* out);//k messages to the same pk, one-time setup shared
 uint8_t* BRLWE_Decry(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, uint8_t* recoverm);
 uint8_t* BRLWE_Decode(uint8_t* recoverm);
 
@@ -41,6 +42,7 @@ BRLWE_Ring_polynomials BRLWE_init_hex(BRLWE_Ring_polynomials poly, uint16_t* str
 BRLWE_Ring_polynomials BRLWE_init(BRLWE_Ring_polynomials poly);//initialize a polynomial with all 0.
 BRLWE_Ring_polynomials2 BRLWE_Key_Gen(const BRLWE_Ring_polynomials a, BRLWE_Ring_polynomials2 key);
 BRLWE_Ring_polynomials2 BRLWE_Encry(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint16_t* m, BRLWE_Ring_polynomials2 cryptom );
+BRLWE_Ring_polynomials2* BRLWE_Encry_batch(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, uint16_t** msgs, int k, BRLWE_Ring_polynomials2* out);//k messages to the same pk, one-time setup shared
 uint16_t* BRLWE_Decry(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, uint16_t* recoverm);
 uint16_t* BRLWE_Decode(uint16_t* recoverm);
 
@@ -50,4 +52,53 @@ BRLWE_Ring_polynomials Ring_mul(const BRLWE_Ring_polynomials a, const BRLWE_Ring
 
 #endif
 
-#endif
\ No newline at end of file
+//Lossy Kyber style compression to d bits per coefficient, in place (see BRLWE_DPK/BRLWE_DC1/BRLWE_DC2 in params.h)
+BRLWE_Ring_polynomials BRLWE_Compress(BRLWE_Ring_polynomials poly, int d);
+BRLWE_Ring_polynomials BRLWE_Decompress(BRLWE_Ring_polynomials poly, int d);
+BRLWE_Ring_polynomials BRLWE_Decry_compressed(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, BRLWE_Ring_polynomials recoverm, int d1, int d2);
+
+//Binary wire format: a 4 byte header followed by the coefficients packed LSB first,
+//BRLWE_QBITS bits each (13 for q = 7681, 7 or 8 for the power-of-two sets), 1 bit for the
+//binary secret key, the compressed width for a compressed public key or ciphertext (BRLWE_DPK/BRLWE_DC1/BRLWE_DC2)
+#define BRLWE_WIRE_MAGIC 0xb7
+
+enum brlwe_wire_type {
+	BRLWE_WIRE_PK = 1, //N coefficients
+	BRLWE_WIRE_SK,     //N binary coefficients
+	BRLWE_WIRE_CT      //c1 then c2, N coefficients each
+};
+
+struct brlwe_wire_hdr {
+	uint8_t magic; //BRLWE_WIRE_MAGIC
+	uint8_t set;   //BRLWE_SET (params.h): 1 n256q128, 2 n256q256, 3 n512q256, 4 n128q7681, 5 n4q256
+	uint8_t type;  //enum brlwe_wire_type
+	uint8_t bits;  //bits per coefficient; ciphertext: c1 in bits 3:0, c2 in bits 7:4
+};
+
+uint32_t BRLWE_Pack(uint8_t* dst, const BRLWE_Ring_polynomials src, int n, int bits);//in place when dst <= src
+void BRLWE_Unpack(BRLWE_Ring_polynomials dst, const uint8_t* src, int n, int bits);//in place when dst >= src
+uint32_t BRLWE_Serialize(struct brlwe_wire_hdr* hdr, int type, BRLWE_Ring_polynomials poly);
+int BRLWE_Deserialize(const struct brlwe_wire_hdr* hdr, BRLWE_Ring_polynomials poly);
+
+//Byte stream encryption: the stream is cut into N bit blocks (N/8 bytes, LSB first),
+//each block is encrypted with its own e1, e2, e3 and emitted as soon as it is complete
+struct brlwe_stream {
+	BRLWE_Ring_polynomials a;
+	BRLWE_Ring_polynomials pk;
+	void (*emit)(void* ctx, const BRLWE_Ring_polynomials2 cryptom);
+	void* ctx;
+	BRLWE_Ring_polynomials2 cryptom;//ciphertext of the current block
+	uint8_t* block;                 //message bytes of the current block
+	uint32_t fill;                  //bytes in block
+	uint32_t blocks;                //ciphertext blocks emitted
+	uint32_t bytes;                 //stream length so far
+	int error;                      //a block could not be encrypted (out of heap), no block is emitted after it
+};
+
+BRLWE_Ring_polynomials2 BRLWE_Encry_bits(const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, const uint8_t* mbits, BRLWE_Ring_polynomials2 cryptom);
+uint8_t* BRLWE_Decry_bits(const BRLWE_Ring_polynomials2 cryptom, const BRLWE_Ring_polynomials r2, uint8_t* mbits);//single pass on the 8-bit path
+int BRLWE_Stream_init(struct brlwe_stream* st, const BRLWE_Ring_polynomials a, const BRLWE_Ring_polynomials pk, void (*emit)(void* ctx, const BRLWE_Ring_polynomials2 cryptom), void* ctx);
+int BRLWE_Stream_update(struct brlwe_stream* st, const uint8_t* data, uint32_t len);
+uint32_t BRLWE_Stream_final(struct brlwe_stream* st);
+
+#endif
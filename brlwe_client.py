@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+#
+# Host side of the firmware service mode (firmware built with -DSERVICE_EN=1,
+# service_run() in firmware.c): binary request/response frames over the UART,
+# to a board or to the iverilog testbench as a stand-in (hx8kdemo_tb.v
+# +uartin/+uartout through two named pipes). Runs keygen, load-pk, count x
+# (encrypt, decrypt) and stats, checks every decrypted message and reports
+# the end to end operations per second, UART transfers included. Used by
+# "make hx8ksvcsim".
+#
+#   ./brlwe_client.py --port /dev/ttyUSB1 [--baud 115200] [--count n]
+#   ./brlwe_client.py --sim hx8kdemo_tb.vvp --firmware hx8kdemo_svcsimfw.hex [--count n]
+#
+# Simulation times are converted to seconds at --cpu-hz (the board clock),
+# not the wall clock time of the simulator.
+#
+# Frames, lengths little endian:
+#   request  : cmd (1 byte), len (2 bytes), payload (len bytes)
+#   response : status (1 byte), len (2 bytes), payload (len bytes)
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import time
+
+KEYGEN, LOAD_PK, ENCRYPT, DECRYPT, STATS, QUIT = 1, 2, 3, 4, 5, 0x7f
+CMD_NAMES = {KEYGEN: "keygen", LOAD_PK: "load-pk", ENCRYPT: "encrypt", DECRYPT: "decrypt", STATS: "stats"}
+STATUS_NAMES = ["ok", "bad command", "bad frame", "no key", "out of heap"]
+
+WIRE_MAGIC = 0xb7
+# BRLWE_SET in params.h -> (name, N)
+PARAM_SETS = {1: ("n256q128", 256), 2: ("n256q256", 256), 3: ("n512q256", 512),
+              4: ("n128q7681", 128), 5: ("n4q256", 4)}
+
+class ServiceError(Exception):
+    pass
+
+class SerialTransport:
+    def __init__(self, port, baud, timeout):
+        import serial
+        self.ser = serial.Serial(port, baud, timeout=timeout)
+        self.t_last = None
+
+    def wait_ready(self):
+        # the banner is sent once at boot: reset the board after starting the client
+        print("waiting for \"service ready\" (reset the board)..", file=sys.stderr)
+        line = b""
+        while not line.endswith(b"service ready"):
+            c = self.ser.read(1)
+            if not c:
+                raise ServiceError("no \"service ready\" banner")
+            line = b"" if c in b"\r\n" else line + c
+        self.ser.read(2) # "\r\n"
+        self.t_last = time.perf_counter()
+
+    def request(self, frame):
+        self.t_last = time.perf_counter()
+        self.ser.write(frame)
+        head = self.read(3)
+        data = self.read(head[1] | head[2] << 8)
+        t = time.perf_counter()
+        elapsed, self.t_last = t - self.t_last, t
+        return head[0], data, elapsed
+
+    def read(self, n):
+        data = self.ser.read(n)
+        if len(data) != n:
+            raise ServiceError("UART timeout")
+        return data
+
+    def close(self, quit):
+        self.ser.close()
+
+class SimTransport:
+    def __init__(self, vvp, firmware, cpu_hz, log):
+        self.dir = tempfile.mkdtemp(prefix="brlwe_client_")
+        self.uartin = os.path.join(self.dir, "uartin")
+        self.uartout = os.path.join(self.dir, "uartout")
+        os.mkfifo(self.uartin)
+        os.mkfifo(self.uartout)
+        self.log = open(log, "w") if log else subprocess.DEVNULL
+        self.proc = subprocess.Popen(["vvp", "-N", vvp, "+firmware=" + firmware,
+                                      "+uartin=" + self.uartin, "+uartout=" + self.uartout,
+                                      "+maxcycles=2000000000", "+nodump"],
+                                     stdout=self.log, stderr=subprocess.STDOUT)
+        # same order as hx8kdemo_tb.v opens them, else both sides block
+        self.fin = open(self.uartin, "wb")
+        self.fout = open(self.uartout, "r")
+        self.cpu_hz = cpu_hz
+        self.cycle = None
+
+    def next_frame(self):
+        data = bytearray()
+        for line in self.fout:
+            line = line.strip()
+            if line.startswith("#"):
+                return bytes(data), int(line[1:])
+            if line:
+                data.append(int(line, 16))
+        raise ServiceError("simulation ended (timeout or firmware crash)")
+
+    def wait_ready(self):
+        # the simulation stands still while it waits for a request, so the cycle stamps
+        # after each response frame give the end to end time of every request
+        _, self.cycle = self.next_frame()
+
+    def request(self, frame):
+        self.fin.write(frame)
+        self.fin.flush()
+        data, cycle = self.next_frame()
+        if len(data) < 3 or len(data) != 3 + (data[1] | data[2] << 8):
+            raise ServiceError("bad response frame")
+        elapsed, self.cycle = (cycle - self.cycle) / self.cpu_hz, cycle
+        return data[0], data[3:], elapsed
+
+    def close(self, quit):
+        if quit:
+            # no response: the firmware ends the simulation
+            self.fin.write(bytes([QUIT, 0, 0]))
+        self.fin.close()
+        self.proc.wait()
+        self.fout.close()
+        os.unlink(self.uartin)
+        os.unlink(self.uartout)
+        os.rmdir(self.dir)
+
+class Client:
+    def __init__(self, transport):
+        self.t = transport
+        self.times = dict()
+
+    def call(self, cmd, payload=b""):
+        frame = bytes([cmd, len(payload) & 0xff, len(payload) >> 8]) + payload
+        status, data, elapsed = self.t.request(frame)
+        if status != 0:
+            name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+            raise ServiceError("%s: %s" % (CMD_NAMES[cmd], name))
+        self.times.setdefault(cmd, []).append(elapsed)
+        return data
+
+def wire_header(data, kind):
+    if len(data) < 4 or data[0] != WIRE_MAGIC or data[2] != kind or data[1] not in PARAM_SETS:
+        raise ServiceError("bad wire header %s" % data[:4].hex())
+    return PARAM_SETS[data[1]]
+
+def run(client, count, seed):
+    rnd = random.Random(seed)
+    pk = client.call(KEYGEN)
+    params, n = wire_header(pk, 1)
+    client.call(LOAD_PK, pk)
+    errors = 0
+    for i in range(count):
+        msg = bytes(rnd.getrandbits(8) for _ in range((n + 7) // 8))
+        if n % 8:
+            msg = msg[:-1] + bytes([msg[-1] & ((1 << n % 8) - 1)])
+        ct = client.call(ENCRYPT, msg)
+        wire_header(ct, 3)
+        rec = client.call(DECRYPT, ct)
+        bits = sum(bin(a ^ b).count("1") for a, b in zip(msg, rec))
+        if bits:
+            print("message %d: %d bit errors" % (i, bits), file=sys.stderr)
+            errors += 1
+    stats = client.call(STATS)
+    return params, n, len(pk), len(ct), errors, stats
+
+def main():
+    ap = argparse.ArgumentParser(description="BRLWE UART service client")
+    ap.add_argument("--port", help="serial port of the board")
+    ap.add_argument("--baud", type=int, default=115200, help="12 MHz / reg_uart_clkdiv 104")
+    ap.add_argument("--timeout", type=float, default=10.0, help="serial timeout (s)")
+    ap.add_argument("--sim", metavar="VVP", help="testbench to run instead (hx8kdemo_tb.vvp)")
+    ap.add_argument("--firmware", default="hx8kdemo_svcsimfw.hex", help="+firmware for --sim")
+    ap.add_argument("--log", help="testbench output for --sim")
+    ap.add_argument("--cpu-hz", type=int, default=12000000, help="core clock for --sim times")
+    ap.add_argument("--count", type=int, default=4, help="encrypt/decrypt round trips")
+    ap.add_argument("--seed", type=int, default=1, help="message generator seed")
+    args = ap.parse_args()
+
+    if bool(args.port) == bool(args.sim):
+        ap.error("one of --port or --sim is needed")
+    if args.count < 1:
+        ap.error("--count must be at least 1")
+    if args.sim:
+        transport = SimTransport(args.sim, args.firmware, args.cpu_hz, args.log)
+    else:
+        transport = SerialTransport(args.port, args.baud, args.timeout)
+
+    try:
+        transport.wait_ready()
+        client = Client(transport)
+        params, n, pk_bytes, ct_bytes, errors, stats = run(client, args.count, args.seed)
+    finally:
+        transport.close(quit=bool(args.sim))
+
+    print("service,%s,%s,pk %d bytes,ciphertext %d bytes,%d/%d messages ok" %
+          (params, "sim" if args.sim else args.port, pk_bytes, ct_bytes, args.count - errors, args.count))
+    print("service,op,calls,end_to_end_ms,ops_per_s,device_cycles_per_call")
+    for cmd in (KEYGEN, LOAD_PK, ENCRYPT, DECRYPT):
+        times = client.times.get(cmd, [])
+        # STATS: successful calls and their cycles per command, counted on the device before this STATS
+        calls = int.from_bytes(stats[8 * (cmd - 1):8 * (cmd - 1) + 4], "little")
+        cycles = int.from_bytes(stats[8 * (cmd - 1) + 4:8 * cmd], "little")
+        avg = sum(times) / len(times)
+        print("service,%s,%d,%.2f,%.2f,%d" % (CMD_NAMES[cmd], len(times), avg * 1e3, 1 / avg,
+                                              cycles // calls if calls else 0))
+    rounds = client.times[ENCRYPT] + client.times[DECRYPT]
+    print("service,round_trip,%d,%.2f,%.2f," % (args.count, sum(rounds) / args.count * 1e3,
+                                                args.count / sum(rounds)))
+    return 1 if errors else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
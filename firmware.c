@@ -23,6 +23,8 @@
 
 #include "params.h"
 #include "alloc.c"
+#include "trace.c"
+#include "stack.c"
 #include "ntt.c"
 #include "brlwe.c"
 
@@ -43,119 +45,36 @@ extern uint32_t sram;
 #define reg_spictrl (*(volatile uint32_t*)0x02000000)
 #define reg_uart_clkdiv (*(volatile uint32_t*)0x02000004)
 #define reg_uart_data (*(volatile uint32_t*)0x02000008)
+#define reg_uart_stat (*(volatile uint32_t*)0x02000014) // see UART_STAT_*
+#define reg_cache_hits (*(volatile uint32_t*)0x0200000C) // write: clear both cache counters
+#define reg_cache_misses (*(volatile uint32_t*)0x02000010)
+#define reg_perf_ctrl (*(volatile uint32_t*)0x02000100) // bit 0: count enable, write bit 1: clear
+#define reg_perf_xfers(i) (*(volatile uint32_t*)(0x02000110 + 8*(i)))
+#define reg_perf_waits(i) (*(volatile uint32_t*)(0x02000114 + 8*(i)))
 #define reg_leds (*(volatile uint32_t*)0x03000000)
 
 #define reg_rng_data (*(volatile uint32_t*)0x03001000)
 
-// --------------------------------------------------------
+#define UART_STAT_IRQ_EN   0x01 // read/write: TX IRQ while the TX FIFO is at most half full
+#define UART_STAT_TX_EMPTY 0x02 // TX FIFO empty and the last byte shifted out
+#define UART_STAT_TX_FULL  0x04
+#define UART_STAT_RX_VALID 0x08
+#define UART_IRQ 4              // irq_uart in picosoc.v
 
-	#if defined(RBINLWEENC1) && (RBINLWEENC1 == 1)
-		#define BRLWE_N 256 // n = 256 : polynomials length
-		#define BRLWE_Q 128 // q = 128 : log2(q) = coeffidences data length; causing 1 bit of each byte wasted when q = 128
-	#elif defined(RBINLWEENC2) && (RBINLWEENC2 == 1)
-	//test bench for configure2(N = 256, Q = 256)
-		#define BRLWE_N 256
-		#define BRLWE_Q 256
-	static const uint8_t test_1[BRLWE_N] = { \
-		(uint8_t)43,(uint8_t)98,(uint8_t)100,(uint8_t)95,(uint8_t)218,(uint8_t)37,(uint8_t)156,(uint8_t)50\
-		,(uint8_t)45,(uint8_t)89,(uint8_t)128,(uint8_t)74,(uint8_t)14,(uint8_t)182,(uint8_t)53,(uint8_t)216\
-		,(uint8_t)235,(uint8_t)220,(uint8_t)90,(uint8_t)98,(uint8_t)41,(uint8_t)129,(uint8_t)116,(uint8_t)44\
-		,(uint8_t)105,(uint8_t)116,(uint8_t)127,(uint8_t)124,(uint8_t)75,(uint8_t)53,(uint8_t)70,(uint8_t)171\
-		,(uint8_t)178,(uint8_t)155,(uint8_t)53,(uint8_t)123,(uint8_t)148,(uint8_t)39,(uint8_t)228,(uint8_t)233\
-		,(uint8_t)20,(uint8_t)75,(uint8_t)82,(uint8_t)238,(uint8_t)91,(uint8_t)155,(uint8_t)80,(uint8_t)108\
-		,(uint8_t)69,(uint8_t)39,(uint8_t)82,(uint8_t)90,(uint8_t)226,(uint8_t)200,(uint8_t)181,(uint8_t)154\
-		,(uint8_t)21,(uint8_t)29,(uint8_t)195,(uint8_t)42,(uint8_t)18,(uint8_t)81,(uint8_t)113,(uint8_t)22\
-		,(uint8_t)146,(uint8_t)211,(uint8_t)71,(uint8_t)194,(uint8_t)136,(uint8_t)140,(uint8_t)48,(uint8_t)165\
-		,(uint8_t)111,(uint8_t)46,(uint8_t)167,(uint8_t)11,(uint8_t)26,(uint8_t)39,(uint8_t)121,(uint8_t)134\
-		,(uint8_t)27,(uint8_t)198,(uint8_t)36,(uint8_t)37,(uint8_t)230,(uint8_t)44,(uint8_t)117,(uint8_t)1\
-		,(uint8_t)156,(uint8_t)165,(uint8_t)147,(uint8_t)226,(uint8_t)15,(uint8_t)200,(uint8_t)2,(uint8_t)53\
-		,(uint8_t)94,(uint8_t)123,(uint8_t)224,(uint8_t)103,(uint8_t)0,(uint8_t)29,(uint8_t)57,(uint8_t)23\
-		,(uint8_t)88,(uint8_t)168,(uint8_t)58,(uint8_t)189,(uint8_t)134,(uint8_t)244,(uint8_t)146,(uint8_t)81\
-		,(uint8_t)49,(uint8_t)239,(uint8_t)243,(uint8_t)6,(uint8_t)110,(uint8_t)31,(uint8_t)225,(uint8_t)51\
-		,(uint8_t)17,(uint8_t)13,(uint8_t)221,(uint8_t)1,(uint8_t)197,(uint8_t)253,(uint8_t)68,(uint8_t)26\
-		,(uint8_t)69,(uint8_t)171,(uint8_t)80,(uint8_t)40,(uint8_t)174,(uint8_t)130,(uint8_t)203,(uint8_t)74\
-		,(uint8_t)208,(uint8_t)234,(uint8_t)103,(uint8_t)142,(uint8_t)141,(uint8_t)120,(uint8_t)173,(uint8_t)189\
-		,(uint8_t)92,(uint8_t)28,(uint8_t)14,(uint8_t)31,(uint8_t)78,(uint8_t)157,(uint8_t)99,(uint8_t)154\
-		,(uint8_t)64,(uint8_t)111,(uint8_t)38,(uint8_t)11,(uint8_t)122,(uint8_t)130,(uint8_t)245,(uint8_t)177\
-		,(uint8_t)89,(uint8_t)203,(uint8_t)133,(uint8_t)255,(uint8_t)76,(uint8_t)131,(uint8_t)216,(uint8_t)218\
-		,(uint8_t)81,(uint8_t)92,(uint8_t)183,(uint8_t)254,(uint8_t)89,(uint8_t)234,(uint8_t)244,(uint8_t)52\
-		,(uint8_t)125,(uint8_t)150,(uint8_t)20,(uint8_t)93,(uint8_t)165,(uint8_t)175,(uint8_t)172,(uint8_t)89\
-		,(uint8_t)123,(uint8_t)50,(uint8_t)207,(uint8_t)107,(uint8_t)224,(uint8_t)12,(uint8_t)250,(uint8_t)138\
-		,(uint8_t)227,(uint8_t)116,(uint8_t)34,(uint8_t)94,(uint8_t)85,(uint8_t)194,(uint8_t)203,(uint8_t)139\
-		,(uint8_t)71,(uint8_t)75,(uint8_t)83,(uint8_t)11,(uint8_t)8,(uint8_t)121,(uint8_t)26,(uint8_t)217\
-		,(uint8_t)98,(uint8_t)241,(uint8_t)140,(uint8_t)114,(uint8_t)101,(uint8_t)221,(uint8_t)127,(uint8_t)180\
-		,(uint8_t)169,(uint8_t)250,(uint8_t)189,(uint8_t)21,(uint8_t)166,(uint8_t)240,(uint8_t)227,(uint8_t)73\
-		,(uint8_t)40,(uint8_t)118,(uint8_t)128,(uint8_t)80,(uint8_t)181,(uint8_t)199,(uint8_t)187,(uint8_t)245\
-		,(uint8_t)120,(uint8_t)224,(uint8_t)61,(uint8_t)153,(uint8_t)71,(uint8_t)166,(uint8_t)56,(uint8_t)248\
-		,(uint8_t)211,(uint8_t)169,(uint8_t)39,(uint8_t)245,(uint8_t)55,(uint8_t)90,(uint8_t)219,(uint8_t)95\
-		,(uint8_t)106,(uint8_t)202,(uint8_t)94,(uint8_t)15,(uint8_t)53,(uint8_t)227,(uint8_t)165,(uint8_t)69};
-	static const uint8_t test_2[BRLWE_N] = { \
-		  (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1 \
-		, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0 \
-		, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0 \
-		, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0 \
-		, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0 \
-		, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1 \
-		, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1 \
-		, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1 \
-		, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1 \
-		, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)0 \
-		, (uint8_t)1, (uint8_t)1, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)0, (uint8_t)1, (uint8_t)1 };
-#elif defined(RBINLWEENCT) && (RBINLWEENCT == 1)
-	//test bench for configure test(N = 4, Q = 256)
-	#define BRLWE_N 4
-	#define BRLWE_Q 256
-	uint8_t test_1[4] = { (uint8_t)30, (uint8_t)20, (uint8_t)150 , (uint8_t)80 };
-	uint8_t test_2[4] = { (uint8_t)1, (uint8_t)0, (uint8_t)1, (uint8_t)1 };
-#elif defined(RBINLWEENC3) && (RBINLWEENC3 == 1)
-	#define BRLWE_N 512
-	#define BRLWE_Q 256
-	
+// masks all IRQs around code that must not run the (flash resident) IRQ handler
+#if defined(UART_IRQ_EN) && (UART_IRQ_EN == 1)
+#  define IRQ_SAVE(m) uint32_t m = irq_setmask(~0)
+#  define IRQ_RESTORE(m) irq_setmask(m)
 #else
-	
-	static const uint16_t test_1[BRLWE_N] = {\
-	2377, 2546, 7558, 2766, 4666, 5515, 6558, 6060, 5746, 3769, 5579, 3431, 6205, 2711, 408, 3312,\
-	2934, 302, 2388, 7099, 144, 2000, 6475, 5012, 889, 6691, 1092, 2505, 3307, 7020, 3181, 4996,\
-	2822, 5532, 6752, 1410, 7314, 2202, 164, 4786, 6473, 6232, 5122, 2323, 4720, 2971, 3486, 6980,\
-	2986, 3043, 5844, 1716, 2126, 81, 1346, 2573, 6034, 408, 3993, 6994, 2819, 2329, 3928, 334,\
-	457, 5267, 6290, 6158, 2464, 2322, 5477, 7481, 3194, 4418, 4281, 5374, 2907, 5980, 2274, 7065,\
-	5885, 5878, 3600, 7221, 388, 2581, 7166, 6990, 2073, 1113, 4813, 2813, 4491, 7639, 6530, 6561,\
-	7355, 6390, 6, 1319, 2139, 1275, 5063, 6137, 5281, 5002, 7256, 5994, 5353, 6817, 3032, 3236,\
-	4360, 204, 776, 7093, 6374, 1594, 5247, 4951, 5395, 2933, 5264, 3146, 3763, 6119, 4126, 6284};
-	
-	static const uint16_t test_2[BRLWE_N] = { \
-	 1, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,\
-	 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 1, 0, 1,\
-	 0, 1, 1, 1, 0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1,\
-	 1, 0, 1, 1, 1, 0, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,\
-	 0, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0,\
-	 1, 1, 1, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 0,\
-	 0, 1, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 0, 1, 0,\
-	 1, 1, 1, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0};
+#  define IRQ_SAVE(m)
+#  define IRQ_RESTORE(m)
+#endif
 
+uint32_t irq_setmask(uint32_t mask); // start.s
 
-#endif
+// --------------------------------------------------------
+
+#include "testvec.h"
 
 //--------------------------------------------------------------------------
 extern uint32_t flashio_worker_begin;
@@ -171,7 +90,26 @@ void flashio(uint8_t *data, int len, uint8_t wrencmd)
 	while (src_ptr != &flashio_worker_end)
 		*(dst_ptr++) = *(src_ptr++);
 
-	((void(*)(uint8_t*, uint32_t, uint32_t))func)(data, len, wrencmd);
+	IRQ_SAVE(irqmask);
+	((void(*)(uint8_t*, uint32_t, uint32_t, uint32_t))func)(data, len, wrencmd, 0);
+	IRQ_RESTORE(irqmask);
+}
+
+// same as flashio(), but does not return before the flash finished the
+// command (erase/program), because MEMIO can not read flash in the meantime
+void flashio_wait(uint8_t *data, int len, uint8_t wrencmd)
+{
+	uint32_t func[&flashio_worker_end - &flashio_worker_begin];
+
+	uint32_t *src_ptr = &flashio_worker_begin;
+	uint32_t *dst_ptr = func;
+
+	while (src_ptr != &flashio_worker_end)
+		*(dst_ptr++) = *(src_ptr++);
+
+	IRQ_SAVE(irqmask);
+	((void(*)(uint8_t*, uint32_t, uint32_t, uint32_t))func)(data, len, wrencmd, 1);
+	IRQ_RESTORE(irqmask);
 }
 
 #ifdef HX8KDEMO
@@ -272,6 +210,169 @@ void enable_flash_crm()
 }
 #endif
 
+/*
+********************************************************************************
+*                       Boot-time Flash Mode Calibration
+*
+* Description  	: Tries every flash read mode (and on HX8K every latency) on a
+*				  known area of the firmware image, and keeps the fastest one
+*				  that returns the plain SPI checksum FLASHCAL_PASSES times.
+*				  The choice is stored in the flash sector at FLASHCAL_ADDR;
+*				  later boots only re-check the stored setting once.
+*				  The probe itself runs from the stack (flashcal_worker in
+*				  start.s), so a mode the board does not support can not
+*				  break instruction fetch.
+*
+* Parameters  	: None
+*
+* Return  		: SPI ctrl reg bits 23:16 (DDR/QSPI/CRM/dummy) now in use
+********************************************************************************
+*/
+
+#define FLASHCAL_ADDR   0x0F0000                  // flash offset of the 4 KB sector holding the record
+#define FLASHCAL_MAGIC  0x464c4331                // "FLC1"
+#define FLASHCAL_PROBE  ((const uint32_t*)0x00100000) // start of the firmware image
+#define FLASHCAL_WORDS  64                        // words read per probe
+#define FLASHCAL_PASSES 2                         // probes that must all match the reference
+
+struct flashcal_record {
+	uint32_t magic;
+	uint32_t reference;  // checksum of the probe area in plain SPI mode
+	uint32_t cfg;        // SPI ctrl reg bits 23:16 of the selected mode
+	uint32_t check;      // magic ^ reference ^ cfg
+};
+
+#ifdef HX8KDEMO
+// dual, dual-crm, quad, quad-crm, qspi-ddr, qspi-ddr-crm; latency is added in flash_calibrate()
+static const uint8_t flashcal_modes[] = { 0x40, 0x50, 0x20, 0x30, 0x60, 0x70 };
+#else
+// same modes, with the fixed dummy cycles of set_flash_mode_*()
+static const uint8_t flashcal_modes[] = { 0x40, 0x50, 0x24, 0x34, 0x67, 0x77 };
+#endif
+
+extern uint32_t flashcal_worker_begin;
+extern uint32_t flashcal_worker_end;
+
+void flashcal_probe(uint32_t cfg, uint32_t *result)
+{
+	uint32_t func[&flashcal_worker_end - &flashcal_worker_begin];
+
+	uint32_t *src_ptr = &flashcal_worker_begin;
+	uint32_t *dst_ptr = func;
+
+	while (src_ptr != &flashcal_worker_end)
+		*(dst_ptr++) = *(src_ptr++);
+
+	IRQ_SAVE(irqmask);
+	((void(*)(uint32_t, const uint32_t*, uint32_t, uint32_t*, uint32_t))func)
+		(cfg, FLASHCAL_PROBE, FLASHCAL_WORDS, result, (reg_spictrl >> 16) & 0x7f);
+	IRQ_RESTORE(irqmask);
+}
+
+// returns 1 if cfg reproduces the reference checksum, *cycles is the slowest probe
+int flashcal_test(uint32_t cfg, uint32_t reference, uint32_t *cycles)
+{
+	uint32_t result[2];
+
+#ifdef HX8KDEMO
+	set_flash_latency(cfg & 15); // also puts the controller back into plain SPI mode
+#endif
+	*cycles = 0;
+	for (int i = 0; i < FLASHCAL_PASSES; i++) {
+		flashcal_probe(cfg, result);
+		if (result[0] != reference)
+			return 0;
+		if (result[1] > *cycles)
+			*cycles = result[1];
+	}
+	return 1;
+}
+
+void flashcal_apply(uint32_t cfg)
+{
+#ifdef HX8KDEMO
+	set_flash_latency(cfg & 15);
+#endif
+	reg_spictrl = (reg_spictrl & ~0x007f0000) | ((cfg & 0x7f) << 16);
+}
+
+void flashcal_store(struct flashcal_record *rec)
+{
+	uint8_t buffer[4 + sizeof(struct flashcal_record)];
+	uint32_t addr = FLASHCAL_ADDR;
+
+	// Sector Erase (SE 20h)
+	buffer[0] = 0x20;
+	buffer[1] = addr >> 16;
+	buffer[2] = addr >> 8;
+	buffer[3] = addr;
+	flashio_wait(buffer, 4, 0x06);
+
+	// Page Program (PP 02h)
+	buffer[0] = 0x02;
+	buffer[1] = addr >> 16;
+	buffer[2] = addr >> 8;
+	buffer[3] = addr;
+	memcpy(buffer + 4, rec, sizeof(struct flashcal_record));
+	flashio_wait(buffer, 4 + sizeof(struct flashcal_record), 0x06);
+}
+
+uint32_t flash_calibrate()
+{
+	const struct flashcal_record *stored = (const struct flashcal_record *)(0x01000000 + FLASHCAL_ADDR);
+	struct flashcal_record rec;
+	uint32_t result[2];
+	uint32_t cycles, best_cycles, best_cfg, cfg;
+
+	// reference: plain SPI read in the current (boot) mode, which is known to work
+	best_cfg = (reg_spictrl >> 16) & 0x7f;
+	flashcal_probe(best_cfg, result);
+	rec.reference = result[0];
+	best_cycles = result[1];
+
+	// stored setting from a previous boot: re-check it once and use it
+	if (stored->magic == FLASHCAL_MAGIC && stored->reference == rec.reference &&
+			stored->check == (stored->magic ^ stored->reference ^ stored->cfg)) {
+		if (flashcal_test(stored->cfg, rec.reference, &cycles)) {
+			flashcal_apply(stored->cfg);
+			return stored->cfg;
+		}
+	}
+
+	for (int m = 0; m < sizeof(flashcal_modes); m++) {
+#ifdef HX8KDEMO
+		for (int lat = 8; lat >= 1; lat--) {
+			cfg = flashcal_modes[m] | lat;
+			if (!flashcal_test(cfg, rec.reference, &cycles))
+				break; // a shorter latency will not work either
+			if (cycles < best_cycles) {
+				best_cycles = cycles;
+				best_cfg = cfg;
+			}
+		}
+#else
+		cfg = flashcal_modes[m];
+		if (flashcal_test(cfg, rec.reference, &cycles) && cycles < best_cycles) {
+			best_cycles = cycles;
+			best_cfg = cfg;
+		}
+#endif
+	}
+
+	rec.magic = FLASHCAL_MAGIC;
+	rec.cfg = best_cfg;
+	rec.check = rec.magic ^ rec.reference ^ rec.cfg;
+#ifdef HX8KDEMO
+	set_flash_latency(8); // plain SPI mode while the sector is written
+#else
+	set_flash_mode_spi();
+#endif
+	flashcal_store(&rec);
+
+	flashcal_apply(best_cfg);
+	return best_cfg;
+}
+
 // --------------------------------------------------------
 
 //count the total number of error occur in the system
@@ -286,11 +387,76 @@ static int counterr(uint16_t* str1, uint16_t* str2) {
 	return (BRLWE_N - count);
 }
 
+#if defined(UART_IRQ_EN) && (UART_IRQ_EN == 1)
+
+// transmit ring buffer, filled by putchar() and drained into the UART TX FIFO by
+// uart_tx_irq(); only putchar() moves uart_tx_head, only the IRQ handler uart_tx_tail
+static volatile uint8_t uart_tx_buf[UART_TX_BUF];
+static volatile uint32_t uart_tx_head, uart_tx_tail;
+
+static void uart_tx_irq()
+{
+	while (uart_tx_tail != uart_tx_head && !(reg_uart_stat & UART_STAT_TX_FULL))
+		reg_uart_data = uart_tx_buf[uart_tx_tail++ & (UART_TX_BUF - 1)];
+	if (uart_tx_tail == uart_tx_head)
+		reg_uart_stat = 0; // nothing left: no IRQ until the next putchar()
+}
+
+static void uart_putc(char c)
+{
+	if (uart_tx_tail == uart_tx_head && !(reg_uart_stat & UART_STAT_TX_FULL)) {
+		reg_uart_data = c; // ring empty: straight into the FIFO
+		return;
+	}
+	while (uart_tx_head - uart_tx_tail == UART_TX_BUF) { /* ring full: wait for the IRQ */ };
+	uart_tx_buf[uart_tx_head & (UART_TX_BUF - 1)] = c;
+	uart_tx_head++;
+	reg_uart_stat = UART_STAT_IRQ_EN;
+}
+
+#else
+
+static void uart_putc(char c)
+{
+	reg_uart_data = c; // waits while the TX FIFO is full
+}
+
+#endif
+
+/**** 
+	Description : IRQ handler, called by irq_entry in start.s
+	Parameters : irqs - pending IRQ bits
+*****/
+void irq_handler(uint32_t irqs)
+{
+#if defined(UART_IRQ_EN) && (UART_IRQ_EN == 1)
+	if (irqs & (1 << UART_IRQ))
+		uart_tx_irq();
+#endif
+}
+
+// unmask the UART IRQ (UART_IRQ_EN = 1), after the flash setup
+void uart_init()
+{
+#if defined(UART_IRQ_EN) && (UART_IRQ_EN == 1)
+	irq_setmask(~(1 << UART_IRQ));
+#endif
+}
+
+// wait until everything printed so far has left the UART
+void uart_flush()
+{
+#if defined(UART_IRQ_EN) && (UART_IRQ_EN == 1)
+	while (uart_tx_tail != uart_tx_head) { /* wait */ };
+#endif
+	while (!(reg_uart_stat & UART_STAT_TX_EMPTY)) { /* wait */ };
+}
+
 void putchar(char c)
 {
 	if (c == '\n')
-		putchar('\r');
-	reg_uart_data = c;
+		uart_putc('\r');
+	uart_putc(c);
 }
 
 void print(const char *p)
@@ -437,6 +603,43 @@ void mem_print(void)
     }
     print("\r\n#############################\r\n");
 }
+
+#if defined(MEM_STATS_EN) && (MEM_STATS_EN == 1)
+
+/**** 
+	Description : print the heap statistics of alloc.c since the last mem_stats_reset():
+	              usage and peaks, free space and fragmentation, list walks per call,
+	              and allocations per call site (return address, see firmware.elf
+	              disassembly or addr2line)
+*****/
+void mem_stats_dump(void)
+{
+	struct mem_stats st;
+	mem_stats_get(&st);
+	print("\n Heap: size = ");print_dec(MEM_SIZE);
+	print(", used = ");print_dec(st.cur_bytes);
+	print(", peak = ");print_dec(st.peak_bytes);
+	print(", peak with headers = ");print_dec(st.peak_heap);
+	print("\n Heap: free = ");print_dec(st.free_bytes);
+	print(" in ");print_dec(st.free_blocks);print(" blocks, largest = ");print_dec(st.largest_free);
+	print("\n Heap: malloc = ");print_dec(st.mallocs);
+	print(" (failed ");print_dec(st.failures);
+	print("), blocks walked = ");print_dec(st.malloc_walk);
+	print(", worst call = ");print_dec(st.malloc_walk_max);
+	print("\n Heap: free = ");print_dec(st.frees);
+	print(", blocks walked = ");print_dec(st.free_walk);
+	print(", worst call = ");print_dec(st.free_walk_max);
+	for (int i = 0; i < MEM_SITES && st.sites[i].site; i++) {
+		print("\n Heap: site ");print_Hex_32((uint32_t)st.sites[i].site);
+		print(" : allocations = ");print_dec(st.sites[i].count);
+		print(", bytes = ");print_dec(st.sites[i].bytes);
+	}
+	if (st.site_other) {
+		print("\n Heap: other sites : allocations = ");print_dec(st.site_other);
+	}
+}
+
+#endif
  
 void buff_print(unsigned char *buf,unsigned int len)
 {
@@ -534,8 +737,16 @@ void alloc_test(void)
 ********************************************************************************
 */
 
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+#include "prng.h"
+#endif
+
 void setseed32(uint32_t seed)
 {	
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+	prng_seed(seed);
+	return;
+#endif
 	/*int i;
 	uint32_t tmp = 0x00000000;
 	for (i = 0; i < 4; i++) {
@@ -574,6 +785,10 @@ void getrandom_binary(uint8_t* str)
 	uint32_t tmp = 0xffffffff;//impossible value of the RNG output
 	int i = 0;
 	
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+	prng_binary(str);
+	return;
+#endif
 	while (tmp == 0xffffffff) {
 			tmp = reg_rng_data;
 		}// if RNG is not ready(tmp=0xffff_ffff), wait.
@@ -609,6 +824,634 @@ void debug_rdcycle()
 	print("\r\n");
 }
 
+/**** Bus performance counters (picosoc_perf in picosoc.v) 
+	Description : transfers and wait cycles per bus target, plus the flash cache counters
+*****/
+
+#define BUS_TARGETS 6
+
+static const char* const bus_target_names[BUS_TARGETS] = {"flash", "SRAM", "UART", "RNG", "user RAM", "iomem"};
+
+struct bus_perf {
+	uint32_t xfers[BUS_TARGETS];
+	uint32_t waits[BUS_TARGETS];
+	uint32_t cache_hits;
+	uint32_t cache_misses;
+};
+
+/**** 
+	Description : clear all counters and start counting
+*****/
+void bus_perf_reset()
+{
+	reg_cache_hits = 0;
+	reg_perf_ctrl = 3;
+}
+
+/**** 
+	Description : copy the counters while counting is stopped, then continue counting
+	Parameters : p - snapshot destination
+*****/
+void bus_perf_snapshot(struct bus_perf* p)
+{
+	reg_perf_ctrl = 0;
+	p->cache_hits = reg_cache_hits;
+	p->cache_misses = reg_cache_misses;
+	for (int i = 0; i < BUS_TARGETS; i++) {
+		p->xfers[i] = reg_perf_xfers(i);
+		p->waits[i] = reg_perf_waits(i);
+	}
+	reg_perf_ctrl = 1;
+}
+
+void bus_perf_print(const struct bus_perf* p)
+{
+	for (int i = 0; i < BUS_TARGETS; i++) {
+		if (p->xfers[i] == 0 && p->waits[i] == 0) continue;
+		print("\n Bus ");print(bus_target_names[i]);
+		print(" : transfers = ");print_dec(p->xfers[i]);
+		print(", wait cycles = ");print_dec(p->waits[i]);
+	}
+	print("\n Flash cache hits = ");print_dec(p->cache_hits);
+	print(", misses = ");print_dec(p->cache_misses);
+}
+
+#if defined(TRACE_EN) && (TRACE_EN == 1)
+
+static const char* const trace_names[TRACE_EVENTS] = {"?", "BRLWE_init_bin_sampling", "BRLWE_init_hex", "BRLWE_init", "Ring_add", "Ring_sub", "Ring_mul",
+	"ntt_64", "poly_invntt_64", "pt_ntt_bowtiemultiply", "ntt_pt", "pt_ntt_basemul", "BRLWE_Decode", "BRLWE_Decry_kernel"};
+
+/**** 
+	Description : print one line per traced function call that ended since the
+	              last trace_reset(): cycles and retired instructions between its
+	              entry and exit, and the 64-bit cycle count at entry; then clear the trace
+*****/
+void trace_dump()
+{
+	struct trace_entry e, b;
+	if (trace_lost()) {
+		print("\n Trace: ");print_dec(trace_lost());print(" entries lost, raise TRACE_DEPTH");
+	}
+	for (int n = 0; trace_get(n, &e); n++) {
+		if (!(e.event & TRACE_END))
+			continue;
+		// matching entry: skip over completed calls of the same function
+		int depth = 0;
+		int m;
+		for (m = n - 1; trace_get(m, &b); m--) {
+			if (b.event == e.event)
+				depth++;
+			else if (b.event == (e.event & ~TRACE_END) && depth-- == 0)
+				break;
+		}
+		if (m < 0)
+			continue;
+		uint32_t id = b.event < TRACE_EVENTS ? b.event : 0;
+		print("\n Cycles Number for ");print(trace_names[id]);print(" = ");print_dec(e.cycle_lo - b.cycle_lo);
+		print(", instret = ");print_dec(e.instret - b.instret);
+		print(", at ");print_Hex_32(b.cycle_hi);print_hex(b.cycle_lo >> 16, 4);print_hex(b.cycle_lo & 0xffff, 4);
+	}
+	trace_reset();
+}
+
+/**** 
+	Description : print calls, total cycles, total retired instructions and
+	              cycles per instruction (2 decimals) of every traced function and
+	              kernel called since the last trace_reset(); call before trace_dump()
+*****/
+void trace_stats_dump()
+{
+	struct trace_stats s;
+	for (uint32_t id = 1; trace_stats_get(id, &s); id++) {
+		if (s.calls == 0)
+			continue;
+		print("\n Kernel ");print(trace_names[id]);print(" : calls = ");print_dec(s.calls);
+		print(", cycles = ");print_dec(s.cycles);
+		print(", instret = ");print_dec(s.instret);
+		if (s.instret) {
+			uint32_t frac = (s.cycles % s.instret) * 100 / s.instret;
+			print(", CPI = ");print_dec(s.cycles / s.instret);print(frac < 10 ? ".0" : ".");print_dec(frac);
+		}
+	}
+}
+
+#endif
+
+#if defined(STACK_PAINT_EN) && (STACK_PAINT_EN == 1)
+
+/**** 
+	Description : print the deepest stack use since the last stack_paint(), measured
+	              from the top of the stack, out of the space left between heap and stack top
+*****/
+void stack_print()
+{
+	print("\n Stack: used = ");print_dec(stack_used());
+	print(" of ");print_dec(stack_size());print(" bytes");
+	if (stack_overflow())
+		print(", OVERFLOW into the heap");
+}
+
+#endif
+
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+
+/**** 
+	Description : print "kat <name> = c0 c1 .." in the format of the .kat files in kat/
+	              (hex, 4 digits for q > 256, else 2), so the UART log can be diffed against them
+*****/
+void kat_print(const char* name, const BRLWE_Ring_polynomials poly)
+{
+	print("\nkat ");print(name);print(" =");
+	for (int i = 0; i < BRLWE_N; i++) {
+		print(" ");print_hex(poly[i], BRLWE_Q > 256 ? 4 : 2);
+	}
+}
+
+#endif
+
+/**** 
+	Description : pack poly to the wire format in place, print header and size,
+	              unpack it again and compare every coefficient with a copy taken
+	              before packing (needs n coefficients of heap for the copy)
+	Parameters : name - printed name
+	             type - enum brlwe_wire_type
+	             poly - polynomial (ciphertext: [c1,c2]) to pack, restored afterwards
+*****/
+void wire_check(const char* name, int type, BRLWE_Ring_polynomials poly)
+{
+	struct brlwe_wire_hdr hdr;
+	int n = type == BRLWE_WIRE_CT ? 2 * BRLWE_N : BRLWE_N;
+	BRLWE_Ring_polynomials ref = m_malloc(n * sizeof(poly[0]));
+	uint32_t len;
+	int ok, i;
+	if (ref == NULL) {
+		print("\n Wire ");print(name);print(" : no heap for the reference copy");
+		return;
+	}
+	memcpy(ref, poly, n * sizeof(poly[0]));
+	len = BRLWE_Serialize(&hdr, type, poly);
+	print("\n Wire ");print(name);print(" : header ");
+	print_hex(hdr.magic, 2);putchar(' ');print_hex(hdr.set, 2);putchar(' ');
+	print_hex(hdr.type, 2);putchar(' ');print_hex(hdr.bits, 2);
+	print(", ");print_dec(sizeof(hdr) + len);print(" bytes (");print_dec(n * sizeof(poly[0]));print(" unpacked)");
+	ok = BRLWE_Deserialize(&hdr, poly);
+	for (i = 0; ok && i < n; i++)//not memcmp: the one in alloc.c stops at the first common zero byte
+		ok = poly[i] == ref[i];
+	print(ok ? ", round trip ok" : ", round trip FAILED");
+	memcpy(poly, ref, n * sizeof(poly[0]));
+	m_free(ref);
+}
+
+#if defined(COMPRESS_TRIALS) && (COMPRESS_TRIALS > 0)
+
+#if (BRLWE_DPK > 0) || (BRLWE_DC1 > 0) || (BRLWE_DC2 > 0)
+#  error "compress_sweep() needs an uncompressed BRLWE_Key_Gen and BRLWE_Encry: build with BRLWE_DPK = BRLWE_DC1 = BRLWE_DC2 = 0"
+#endif
+
+/**** 
+	Description : decryption failures against compression. For pk, c1 and c2 in turn,
+	              compress that polynomial to d = 1 .. BRLWE_QBITS bits (d = BRLWE_QBITS:
+	              uncompressed reference), leave the others uncompressed, and encrypt and
+	              decrypt trials random messages with one key pair. One CSV line per d:
+	              compress,params,poly,d,bytes,trials,bit_errors,failed_blocks
+	Parameters : trials - messages per poly and d
+*****/
+void compress_sweep(int trials)
+{
+	static const char* const poly_names[3] = {"pk", "c1", "c2"};
+	BRLWE_Ring_polynomials2 key = m_malloc(BRLWE_N * 2 * sizeof(key[0]));
+	BRLWE_Ring_polynomials2 cryptom = m_malloc(BRLWE_N * 2 * sizeof(key[0]));
+	BRLWE_Ring_polynomials pkc = m_malloc(BRLWE_N * sizeof(key[0]));
+	BRLWE_Ring_polynomials m = m_malloc(BRLWE_N * sizeof(key[0]));
+	BRLWE_Ring_polynomials recoverm = m_malloc(BRLWE_N * sizeof(key[0]));
+	uint32_t bit_errors, failed, e;
+
+	BRLWE_Key_Gen((BRLWE_Ring_polynomials) test_1, key);
+	print("\ncompress,params,poly,d,bytes,trials,bit_errors,failed_blocks");
+	for (int poly = 0; poly < 3; poly++) {
+		for (int d = 1; d <= BRLWE_QBITS; d++) {
+			bit_errors = 0;
+			failed = 0;
+			for (int t = 0; t < trials; t++) {
+				BRLWE_init_bin_sampling(m);
+				memcpy(pkc, key, BRLWE_N * sizeof(key[0]));
+				if (poly == 0)
+					BRLWE_Decompress(BRLWE_Compress(pkc, d), d);
+				BRLWE_Encry((BRLWE_Ring_polynomials) test_1, pkc, m, cryptom);
+				if (poly != 0)
+					BRLWE_Compress(cryptom + (poly == 2 ? BRLWE_N : 0), d);
+				BRLWE_Decry_compressed(cryptom, key + BRLWE_N, recoverm, poly == 1 ? d : 0, poly == 2 ? d : 0);
+				e = 0;
+				for (int i = 0; i < BRLWE_N; i++)
+					e += recoverm[i] != m[i];
+				bit_errors += e;
+				failed += e != 0;
+			}
+			print("\ncompress,n");print_dec(BRLWE_N);print("q");print_dec(BRLWE_Q);
+			print(",");print(poly_names[poly]);
+			print(",");print_dec(d);
+			print(",");print_dec(BRLWE_N * d / 8);
+			print(",");print_dec(trials);
+			print(",");print_dec(bit_errors);
+			print(",");print_dec(failed);
+		}
+	}
+	print("\n");
+
+	m_free(recoverm);
+	m_free(m);
+	m_free(pkc);
+	m_free(cryptom);
+	m_free(key);
+}
+
+#endif
+
+#if defined(BENCH_ITERS) && (BENCH_ITERS > 0)
+
+#if (defined(RBINLWEENC1) && (RBINLWEENC1 == 1)) || (defined(RBINLWEENC2) && (RBINLWEENC2 == 1)) || (defined(RBINLWEENC3) && (RBINLWEENC3 == 1)) || (defined(RBINLWEENCT) && (RBINLWEENCT == 1))
+	#define BENCH_BACKEND "schoolbook"
+#elif defined(My_NTT) && (My_NTT == 1)
+	#define BENCH_BACKEND "nbntt"
+#elif defined(PTNTT_INPLACE) && (PTNTT_INPLACE == 1) && (PTNTT_SPLIT == 8)
+	#define BENCH_BACKEND "ptntt8"
+#elif defined(PTNTT_INPLACE) && (PTNTT_INPLACE == 1) && (PTNTT_SPLIT == 4)
+	#define BENCH_BACKEND "ptntt4"
+#elif defined(PTNTT_INPLACE) && (PTNTT_INPLACE == 1)
+	#define BENCH_BACKEND "ptntt2"
+#else
+	#define BENCH_BACKEND "ptntt"
+#endif
+
+enum { BENCH_KEYGEN, BENCH_ENCRY, BENCH_DECRY, BENCH_RING_MUL, BENCH_ENCRY_BATCH, BENCH_STREAM, BENCH_OPS };
+
+static const char* const bench_op_names[BENCH_OPS] = {"keygen", "encrypt", "decrypt", "ring_mul", "encrypt_batch", "stream"};
+
+static void bench_sort(uint32_t* v, int n)
+{
+	for (int i = 1; i < n; i++) {
+		uint32_t x = v[i];
+		int j = i - 1;
+		for (; j >= 0 && v[j] > x; j--)
+			v[j + 1] = v[j];
+		v[j + 1] = x;
+	}
+}
+
+/**** 
+	Description : print ",min,median,mean,max" of n samples (sorts v); the mean
+	              is rounded down and computed without 64-bit arithmetic
+	Returns : the median
+*****/
+static uint32_t bench_print_stats(uint32_t* v, int n)
+{
+	uint32_t mean = 0, rem = 0;
+	for (int i = 0; i < n; i++) {
+		mean += v[i] / n;
+		rem += v[i] % n;
+	}
+	mean += rem / n;
+	bench_sort(v, n);
+	uint32_t median = (n & 1) ? v[n >> 1] : v[(n >> 1) - 1] + ((v[n >> 1] - v[(n >> 1) - 1]) >> 1);
+	print(",");print_dec(v[0]);
+	print(",");print_dec(median);
+	print(",");print_dec(mean);
+	print(",");print_dec(v[n - 1]);
+	return median;
+}
+
+/**** 
+	Description : print "throughput,params,backend,op,msgs,cycles_per_msg,msgs_per_s"
+	              for an operation that handles msgs messages in cycles cycles (median)
+*****/
+static void bench_print_throughput(const char* op, uint32_t msgs, uint32_t cycles)
+{
+	uint32_t per_msg = (cycles + (msgs >> 1)) / msgs;
+	print("\nthroughput,n");print_dec(BRLWE_N);print("q");print_dec(BRLWE_Q);
+	print(",");print(BENCH_BACKEND);
+	print(",");print(op);
+	print(",");print_dec(msgs);
+	print(",");print_dec(per_msg);
+	print(",");print_dec(per_msg ? CPU_HZ / per_msg : 0);
+}
+
+static void bench_stream_emit(void* ctx, const BRLWE_Ring_polynomials2 cryptom)
+{
+	// a real sender would put the ciphertext block on the wire here
+}
+
+/**** 
+	Description : run every operation iters times on the test vectors and print one
+	              CSV line per operation: bench,params,backend,op,iters,
+	              cycles min/median/mean/max, instret min/median/mean/max;
+	              encrypt_batch encrypts BENCH_BATCH_K messages per iteration, and
+	              stream encrypts BENCH_STREAM_BYTES bytes through BRLWE_Stream_*;
+	              the encryptions get a throughput line in messages (blocks) per second
+	Parameters : iters - iterations per operation
+*****/
+void bench_run(int iters)
+{
+	BRLWE_Ring_polynomials2 key = m_malloc(BRLWE_N * 2 * 2);
+	BRLWE_Ring_polynomials2 cryptom = m_malloc(BRLWE_N * 2 * 2);
+	BRLWE_Ring_polynomials recoverm = m_malloc(BRLWE_N * 2);
+	uint32_t* cycles = m_malloc(iters * sizeof(uint32_t));
+	uint32_t* instret = m_malloc(iters * sizeof(uint32_t));
+	uint32_t cycles_begin, cycles_end, instret_begin, instret_end;
+	uint32_t median;
+	BRLWE_Ring_polynomials msgs[BENCH_BATCH_K];
+	BRLWE_Ring_polynomials2 outs[BENCH_BATCH_K];
+	int skipped;
+	struct brlwe_stream st;
+
+	// throughput only: every message is the test vector, every ciphertext goes to the same buffer
+	for (int i = 0; i < BENCH_BATCH_K; i++) {
+		msgs[i] = (BRLWE_Ring_polynomials) test_2;
+		outs[i] = cryptom;
+	}
+
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+	setseed32(RNG_SEED);
+#endif
+	print("\nbench,params,backend,op,iters,cycles_min,cycles_median,cycles_mean,cycles_max,instret_min,instret_median,instret_mean,instret_max");
+
+	BRLWE_Key_Gen((BRLWE_Ring_polynomials) test_1, key);
+
+	for (int op = 0; op < BENCH_OPS; op++) {
+		uart_flush(); // no output drained by the IRQ during the measurement
+		skipped = 0;
+		for (int i = 0; i < iters && !skipped; i++) {
+			__asm__ volatile ("rdinstret %0" : "=r"(instret_begin));
+			__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+			switch (op) {
+			case BENCH_KEYGEN:
+				BRLWE_Key_Gen((BRLWE_Ring_polynomials) test_1, key);
+				break;
+			case BENCH_ENCRY:
+				BRLWE_Encry((BRLWE_Ring_polynomials) test_1, (BRLWE_Ring_polynomials) key, test_2, cryptom);
+				break;
+			case BENCH_DECRY:
+				BRLWE_Decry(cryptom, (BRLWE_Ring_polynomials)(key + BRLWE_N), recoverm);
+				break;
+			case BENCH_RING_MUL:
+				Ring_mul((BRLWE_Ring_polynomials) test_1, (BRLWE_Ring_polynomials)(key + BRLWE_N), recoverm);
+				break;
+			case BENCH_ENCRY_BATCH:
+				skipped = BRLWE_Encry_batch((BRLWE_Ring_polynomials) test_1, (BRLWE_Ring_polynomials) key, msgs, BENCH_BATCH_K, outs) == NULL;
+				break;
+			case BENCH_STREAM:
+				skipped = !BRLWE_Stream_init(&st, (BRLWE_Ring_polynomials) test_1, (BRLWE_Ring_polynomials) key, bench_stream_emit, NULL);
+				if (!skipped) {
+					BRLWE_Stream_update(&st, (const uint8_t*) test_1, BENCH_STREAM_BYTES);
+					BRLWE_Stream_final(&st);
+					skipped = st.error;
+				}
+				break;
+			}
+			__asm__ volatile ("rdcycle %0" : "=r"(cycles_end));
+			__asm__ volatile ("rdinstret %0" : "=r"(instret_end));
+			cycles[i] = cycles_end - cycles_begin;
+			instret[i] = instret_end - instret_begin;
+			trace_reset();
+		}
+		if (skipped) {
+			print("\nbench: ");print(bench_op_names[op]);print(" skipped, out of heap");
+			continue;
+		}
+		print("\nbench,n");print_dec(BRLWE_N);print("q");print_dec(BRLWE_Q);
+		print(",");print(BENCH_BACKEND);
+		print(",");print(bench_op_names[op]);
+		print(",");print_dec(iters);
+		median = bench_print_stats(cycles, iters);
+		bench_print_stats(instret, iters);
+		if (op == BENCH_ENCRY)
+			bench_print_throughput(bench_op_names[op], 1, median);
+		else if (op == BENCH_ENCRY_BATCH)
+			bench_print_throughput(bench_op_names[op], BENCH_BATCH_K, median);
+		else if (op == BENCH_STREAM)
+			bench_print_throughput(bench_op_names[op], (BENCH_STREAM_BYTES + BRLWE_N / 8 - 1) / (BRLWE_N / 8), median);
+	}
+	print("\n");
+
+	m_free(instret);
+	m_free(cycles);
+	m_free(recoverm);
+	m_free(cryptom);
+	m_free(key);
+}
+
+#endif
+
+#if defined(SERVICE_EN) && (SERVICE_EN == 1)
+
+// Service mode frames over the UART, lengths little endian, one response per request
+// (host side: brlwe_client.py):
+//   request  : cmd (1 byte), len (2 bytes), payload (len bytes)
+//   response : status (1 byte), len (2 bytes), payload (len bytes)
+enum svc_cmd {
+	SVC_KEYGEN = 1, // -> wire pk; the key pair stays on the device, pk also becomes the encryption key
+	SVC_LOAD_PK,    // wire pk -> ; encryption key for SVC_ENCRYPT
+	SVC_ENCRYPT,    // SVC_MSG_BYTES message bytes (bit i in byte i / 8, LSB first) -> wire ciphertext
+	SVC_DECRYPT,    // wire ciphertext -> SVC_MSG_BYTES message bytes, with the SVC_KEYGEN secret key
+	SVC_STATS,      // -> calls and cycles (32 bit each) per command SVC_KEYGEN .. SVC_STATS, successful calls only
+	SVC_CMDS,
+	SVC_QUIT = 0x7f // -> ; leave the service loop
+};
+
+enum svc_status {
+	SVC_OK = 0,
+	SVC_ERR_CMD,   // unknown command
+	SVC_ERR_FRAME, // wrong payload length or wire header
+	SVC_ERR_KEY,   // SVC_ENCRYPT before a pk, SVC_DECRYPT before SVC_KEYGEN
+	SVC_ERR_MEM    // out of heap: at start up (every command) or for the working buffers of the command
+};
+
+#define SVC_BITS(d) (((d) > 0 && (d) < BRLWE_QBITS) ? (d) : BRLWE_QBITS)
+#define SVC_MSG_BYTES ((BRLWE_N + 7) / 8)
+#define SVC_PK_BYTES ((BRLWE_N * SVC_BITS(BRLWE_DPK) + 7) / 8)
+#define SVC_CT_BYTES ((BRLWE_N * SVC_BITS(BRLWE_DC1) + 7) / 8 + (BRLWE_N * SVC_BITS(BRLWE_DC2) + 7) / 8)
+
+static uint8_t svc_getc()
+{
+	int32_t c;
+	do {
+		c = reg_uart_data;
+	} while (c == -1);
+	return c;
+}
+
+static void svc_read(void* dst, uint32_t len)
+{
+	uint8_t* p = dst;
+	while (len--)
+		*p++ = svc_getc();
+}
+
+static void svc_write(const void* src, uint32_t len)
+{
+	const uint8_t* p = src;
+	while (len--)
+		reg_uart_data = *p++; // raw bytes, no '\n' translation as in putchar()
+}
+
+static void svc_reply(int status, const struct brlwe_wire_hdr* hdr, const void* data, uint32_t len)
+{
+	uint32_t n = len + (hdr ? sizeof(*hdr) : 0);
+	uint8_t head[3] = { status, n, n >> 8 };
+	svc_write(head, 3);
+	if (hdr)
+		svc_write(hdr, sizeof(*hdr));
+	svc_write(data, len);
+}
+
+/**** 
+	Description : persistent crypto service: read request frames from the UART, run them and
+	              send the response frames (enum svc_cmd) until SVC_QUIT. Prints "service ready"
+	              and writes 0x55 to the LEDs (hx8kdemo_tb.v +uartin) before the first frame,
+	              nothing but response frames afterwards.
+	              Payloads are received into and sent from the polynomial buffers themselves
+	              (the wire format packs and unpacks in place), heap use is 6 N coefficients.
+*****/
+void service_run()
+{
+	BRLWE_Ring_polynomials2 key = m_malloc(BRLWE_N * 2 * sizeof(key[0]));
+	BRLWE_Ring_polynomials2 cryptom = m_malloc(BRLWE_N * 2 * sizeof(key[0]));
+	BRLWE_Ring_polynomials pk = m_malloc(BRLWE_N * sizeof(key[0]));
+	BRLWE_Ring_polynomials recoverm = m_malloc(BRLWE_N * sizeof(key[0]));
+	uint8_t msg[SVC_MSG_BYTES];
+	uint8_t stats[8 * (SVC_CMDS - 1)];
+	uint32_t calls[SVC_CMDS], cycles[SVC_CMDS];
+	uint32_t cycles_begin, cycles_end, len, rlen;
+	struct brlwe_wire_hdr hdr;
+	const struct brlwe_wire_hdr* rhdr;
+	const void* rdata;
+	int cmd, status, have_pk = 0, have_sk = 0;
+	int mem_ok = key && cryptom && pk && recoverm;
+
+	for (int i = 0; i < SVC_CMDS; i++) {
+		calls[i] = 0;
+		cycles[i] = 0;
+	}
+
+	print("\nservice ready\n");
+	uart_flush(); // svc_write() bypasses the putchar() ring buffer
+	reg_leds = 0x55;
+
+	for (;;) {
+		cmd = svc_getc();
+		len = svc_getc();
+		len |= (uint32_t)svc_getc() << 8;
+		rhdr = NULL;
+		rdata = NULL;
+		rlen = 0;
+
+		//payload straight into its buffer, skipped on any error
+		status = mem_ok ? SVC_OK : SVC_ERR_MEM;
+		if (cmd == SVC_QUIT)
+			;
+		else if (cmd < SVC_KEYGEN || cmd >= SVC_CMDS)
+			status = SVC_ERR_CMD;
+		else if (status != SVC_OK)
+			;
+		else if (cmd == SVC_LOAD_PK && len == sizeof(hdr) + SVC_PK_BYTES) {
+			svc_read(&hdr, sizeof(hdr));
+			svc_read(pk, SVC_PK_BYTES);
+			len = 0;
+		} else if (cmd == SVC_ENCRYPT && len == SVC_MSG_BYTES) {
+			svc_read(msg, SVC_MSG_BYTES);
+			len = 0;
+		} else if (cmd == SVC_DECRYPT && len == sizeof(hdr) + SVC_CT_BYTES) {
+			svc_read(&hdr, sizeof(hdr));
+			svc_read(cryptom, SVC_CT_BYTES);
+			len = 0;
+		} else if (len != 0 || cmd == SVC_LOAD_PK || cmd == SVC_ENCRYPT || cmd == SVC_DECRYPT)
+			status = SVC_ERR_FRAME;
+		while (len--)
+			svc_getc();
+
+		if (cmd == SVC_QUIT) {
+			svc_reply(SVC_OK, NULL, NULL, 0);
+			break;
+		}
+		if (status != SVC_OK) {
+			svc_reply(status, NULL, NULL, 0);
+			continue;
+		}
+
+		__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
+		switch (cmd) {
+		case SVC_KEYGEN:
+			have_sk = 0;
+			if (BRLWE_Key_Gen((BRLWE_Ring_polynomials) test_1, key) == NULL) {
+				status = SVC_ERR_MEM;
+				break;
+			}
+			memcpy(pk, key, BRLWE_N * sizeof(key[0]));
+			memcpy(recoverm, key, BRLWE_N * sizeof(key[0]));
+			have_pk = 1;
+			have_sk = 1;
+			rlen = BRLWE_Serialize(&hdr, BRLWE_WIRE_PK, recoverm);
+			rhdr = &hdr;
+			rdata = recoverm;
+			break;
+		case SVC_LOAD_PK:
+			have_pk = hdr.type == BRLWE_WIRE_PK && BRLWE_Deserialize(&hdr, pk);
+			if (!have_pk)
+				status = SVC_ERR_FRAME;
+			break;
+		case SVC_ENCRYPT:
+			if (!have_pk) {
+				status = SVC_ERR_KEY;
+				break;
+			}
+			if (BRLWE_Encry_bits((BRLWE_Ring_polynomials) test_1, pk, msg, cryptom) == NULL) {
+				status = SVC_ERR_MEM;
+				break;
+			}
+			rlen = BRLWE_Serialize(&hdr, BRLWE_WIRE_CT, cryptom);
+			rhdr = &hdr;
+			rdata = cryptom;
+			break;
+		case SVC_DECRYPT:
+			if (!have_sk)
+				status = SVC_ERR_KEY;
+			else if (hdr.type != BRLWE_WIRE_CT || !BRLWE_Deserialize(&hdr, cryptom))
+				status = SVC_ERR_FRAME;
+			else if (BRLWE_Decry(cryptom, key + BRLWE_N, recoverm) == NULL)
+				status = SVC_ERR_MEM;
+			else {
+				rlen = BRLWE_Pack(msg, recoverm, BRLWE_N, 1);
+				rdata = msg;
+			}
+			break;
+		case SVC_STATS:
+			for (int i = 0; i < SVC_CMDS - 1; i++)
+				for (int b = 0; b < 4; b++) {
+					stats[8 * i + b] = calls[i + 1] >> (8 * b);
+					stats[8 * i + 4 + b] = cycles[i + 1] >> (8 * b);
+				}
+			rlen = sizeof(stats);
+			rdata = stats;
+			break;
+		}
+		__asm__ volatile ("rdcycle %0" : "=r"(cycles_end));
+
+		if (status != SVC_OK)
+			svc_reply(status, NULL, NULL, 0);
+		else {
+			calls[cmd]++;//successful calls only, failed ones would skew the cycles per call
+			cycles[cmd] += cycles_end - cycles_begin;
+			svc_reply(SVC_OK, rhdr, rdata, rlen);
+		}
+	}
+
+	if (recoverm) m_free(recoverm);
+	if (pk) m_free(pk);
+	if (cryptom) m_free(cryptom);
+	if (key) m_free(key);
+}
+
+#endif
+
 // --------------------------------------------------------
 
 void cmd_read_flash_id()
@@ -642,22 +1485,36 @@ void main()
 	reg_uart_clkdiv = 104;
 	reg_leds = 63;//=0x3f=8'b0011_1111
 	set_flash_qspi_flag();
+#if defined(FLASHCAL_EN) && (FLASHCAL_EN == 1)
+	uint32_t flash_cfg = flash_calibrate();
+#endif
 	
 	reg_leds = 127;//=0x7f=8'b0111_1111
+	uart_init();
+#if !(defined(SIM_BOOT) && (SIM_BOOT == 1)) && !(defined(SERVICE_EN) && (SERVICE_EN == 1))
 	while (getchar_prompt("Press ENTER to continue..\n") != '\r') {  /* wait */ };	
+#endif
 	
 	print("Booting..\n");
+#if defined(FLASHCAL_EN) && (FLASHCAL_EN == 1)
+	print("Flash mode (spictrl[22:16]) = 0x");print_hex(flash_cfg, 2);print("\n");
+#endif
 	mem_init();
 	mem_print();
+	stack_paint();
 	
 	//RNG Testing
 	uint32_t cycles_now;
 	uint32_t difference;
 	// do{
 	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+	cycles_now = RNG_SEED;
+#endif
 	setseed32(cycles_now);
 	print("\n RNG Seed =");print_Hex_32(cycles_now);
 	
+#if !(defined(SIM_BOOT) && (SIM_BOOT == 1)) && !(defined(SERVICE_EN) && (SERVICE_EN == 1))
 	uint32_t count_1 = 0;
 	uint32_t count_0 = 0;
 	
@@ -691,6 +1548,7 @@ void main()
 	// }while(difference > 50);
 	
 	print("\nEnd of RNG testing");
+#endif
 	
 	
 	//test: memory allocate testing & RNG initialization
@@ -751,26 +1609,45 @@ void main()
 	m_free(n);
 	*/
 	
-	//Test : Timing test: Table plot 
-	//print("\n| I \t| bin_sampling \t| Ring_mul \t| *Key_Gen \t| bin_sampling \t| Ring_mul_1 \t| Ring_mul_2 \t| *Encryp \t| Ring_mul \t| Ring_add \t| *Decryp \t| Result Check \t");
-	
-	//for (int i = 1; i <= 50; i++){
-	// print("\n| ");print_dec(i);
-	
+#if defined(BENCH_ITERS) && (BENCH_ITERS > 0)
+	//Timing test: BENCH_ITERS runs of every operation, CSV summary (see performance.py)
+	bench_run(BENCH_ITERS);
+#elif defined(COMPRESS_TRIALS) && (COMPRESS_TRIALS > 0)
+	//Bandwidth against correctness: decryption failures for every compression width
+	compress_sweep(COMPRESS_TRIALS);
+#elif defined(SERVICE_EN) && (SERVICE_EN == 1)
+	//Binary UART service loop (brlwe_client.py)
+	service_run();
+#else
 	//test: Key Generation step
 	
 	uint32_t cycles_begin;
+	struct bus_perf bus;
 	
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+	setseed32(RNG_SEED); // same samples as the host KAT generator, whatever the RNG test used
+#endif
+	
+	mem_stats_reset();
 	BRLWE_Ring_polynomials2 key = NULL;
 	key = m_malloc(BRLWE_N * 2 * 2);
 	// print("\n mem_print() 1 \n");
 	// mem_print();
 	print("\n \nKey Generation:\n");
+	bus_perf_reset();
+	trace_reset();
+	stack_paint();
 	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
-	key = BRLWE_Key_Gen((BRLWE_Ring_polynomials) test_1, key);
+	if (BRLWE_Key_Gen((BRLWE_Ring_polynomials) test_1, key) == NULL)
+		print("\n Key Generation: out of heap\n");
 	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
+	bus_perf_snapshot(&bus);
 	print("\t|* ");print_dec(cycles_now - cycles_begin);
 	print("\n Cycles Number for Key Generation = ");print_dec(cycles_now - cycles_begin);
+	bus_perf_print(&bus);
+	trace_stats_dump();
+	trace_dump();
+	stack_print();
 	// mem_print();
 	print("\npublic key = \n");
 	phex(key);
@@ -792,11 +1669,20 @@ void main()
 	BRLWE_Ring_polynomials2 cryptom = NULL;
 	cryptom = m_malloc(BRLWE_N * 2 * 2);
 	
+	bus_perf_reset();
+	trace_reset();
+	stack_paint();
 	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
-	cryptom = BRLWE_Encry( (BRLWE_Ring_polynomials) test_1, (BRLWE_Ring_polynomials) key, test_2, cryptom);
+	if (BRLWE_Encry( (BRLWE_Ring_polynomials) test_1, (BRLWE_Ring_polynomials) key, test_2, cryptom) == NULL)
+		print("\n Encryption: out of heap\n");
 	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
+	bus_perf_snapshot(&bus);
 	print("\t|* ");print_dec(cycles_now - cycles_begin);
 	print("\n Cycles Number for Encryption = ");print_dec(cycles_now - cycles_begin);
+	bus_perf_print(&bus);
+	trace_stats_dump();
+	trace_dump();
+	stack_print();
 	// mem_print();
 	print("\nsecret message 1 = \n");
 	phex(cryptom);
@@ -817,11 +1703,20 @@ void main()
 	uint16_t* recoverm = NULL;
 	recoverm = m_malloc(BRLWE_N * 2);
 	
+	bus_perf_reset();
+	trace_reset();
+	stack_paint();
 	__asm__ volatile ("rdcycle %0" : "=r"(cycles_begin));
-	recoverm = BRLWE_Decry(cryptom, (BRLWE_Ring_polynomials)(key + BRLWE_N), recoverm);
+	if (BRLWE_Decry(cryptom, (BRLWE_Ring_polynomials)(key + BRLWE_N), recoverm) == NULL)
+		print("\n Decryption: out of heap\n");
 	__asm__ volatile ("rdcycle %0" : "=r"(cycles_now));
+	bus_perf_snapshot(&bus);
 	// print("\t|* ");print_dec(cycles_now - cycles_begin);
 	print("\n Cycles Number for Decryption = ");print_dec(cycles_now - cycles_begin);
+	bus_perf_print(&bus);
+	trace_stats_dump();
+	trace_dump();
+	stack_print();
 	// mem_print();
 	print("\noriginal message = \n");
 	phex(test_2);
@@ -841,13 +1736,30 @@ void main()
 		// print("\t| failed! Number of Error bit:");print("\t ");print_dec(count);
 		
 	}
+#if defined(RNG_SEEDED) && (RNG_SEEDED == 1)
+	kat_print("pk", key);
+	kat_print("sk", key + BRLWE_N);
+	kat_print("c1", cryptom);
+	kat_print("c2", cryptom + BRLWE_N);
+	kat_print("m", recoverm);
+	print("\n");
+#endif
+	wire_check("pk", BRLWE_WIRE_PK, key);
+	wire_check("sk", BRLWE_WIRE_SK, key + BRLWE_N);
+	wire_check("ciphertext", BRLWE_WIRE_CT, cryptom);
+	print("\n");
 	//mem_print();
 	m_free(key);
 	m_free(cryptom);
 	m_free(recoverm);
 	//mem_print();
+	mem_stats_dump(); // whole KeyGen/Encrypt/Decrypt round
+#endif
+#if defined(SIM_BOOT) && (SIM_BOOT == 1)
+	uart_flush(); // the testbench stops at the marker
+	reg_leds = 0xa5; // end of run marker for hx8kdemo_tb.v
+#endif
 	
-	//}
 	//mem_print();
 	
 	//mem_print();
@@ -17,6 +17,16 @@
  *
  */
 
+// flash read cache size in bytes (0, 256, 512 or 1024), see spimemio_cache
+`ifndef HX8K_CACHE_BYTES
+`define HX8K_CACHE_BYTES 512
+`endif
+
+// 1: picorv32 ENABLE_FAST_MUL (a few cycles per multiply, more LUTs) instead of the sequential one
+`ifndef HX8K_FAST_MUL
+`define HX8K_FAST_MUL 0
+`endif
+
 module hx8kdemo (
 	input clk,
 
@@ -128,7 +138,12 @@ module hx8kdemo (
 	end
 
 	picosoc #(
-		.MEM_WORDS(1536)
+		.MEM_WORDS(1536),
+		.CACHE_BYTES(`HX8K_CACHE_BYTES),
+		.ENABLE_FAST_MUL(`HX8K_FAST_MUL),
+		.PERF_RNG_ADDR(32'h 0300_1000),
+		.PERF_URAM_ADDR(32'h 0300_2000),
+		.PERF_URAM_BYTES(4*256)
 	) soc (
 		.clk          (clk         ),
 		.resetn       (resetn      ),
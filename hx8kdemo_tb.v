@@ -26,15 +26,23 @@ module testbench;
 	localparam ser_half_period = 53;
 	event ser_sample;
 
-	initial begin
-		$dumpfile("testbench.vcd");
-		$dumpvars(0, testbench);
-		$dumpflush;
+	// +maxcycles=<n> : simulation length (default 500000 cycles)
+	// +nodump         : no testbench.vcd (for long benchmark runs)
+	integer max_cycles;
 
-		repeat (10) begin
-			repeat (50000) @(posedge clk);
-			//$display("+50000 cycles");
+	initial begin
+		if (!$test$plusargs("nodump")) begin
+			$dumpfile("testbench.vcd");
+			$dumpvars(0, testbench);
+			$dumpflush;
 		end
+
+		if (!$value$plusargs("maxcycles=%d", max_cycles))
+			max_cycles = 500000;
+
+		repeat (max_cycles) @(posedge clk);
+		$display("\nSimulation timeout after %0d cycles", max_cycles);
+		report_stats;
 		$finish;
 	end
 
@@ -44,9 +52,28 @@ module testbench;
 		cycle_cnt <= cycle_cnt + 1;
 	end
 
+	task report_stats;
+		begin
+			$display("Simulated cycles = %0d", cycle_cnt);
+`ifndef HX8K_SYNSIM
+			$display("Flash cache bytes = %0d, hits = %0d, misses = %0d", uut.soc.CACHE_BYTES,
+					uut.soc.cache_hits_do, uut.soc.cache_misses_do);
+`endif
+		end
+	endtask
+
+	// firmware built with SIM_BOOT=1 writes 0xa5 to the LEDs when it is done
+	always @(posedge clk) begin
+		if (leds == 8'h a5) begin
+			$display("\nFirmware done");
+			report_stats;
+			$finish;
+		end
+	end
+
 	wire [7:0] leds;
 
-	wire ser_rx;
+	reg ser_rx = 1;
 	wire ser_tx;
 
 	wire flash_csb;
@@ -82,6 +109,78 @@ module testbench;
 		.io3(flash_io3)
 	);
 
+	// +uartin=<file>  : firmware built with SERVICE_EN=1: once it writes 0x55 to the LEDs, send the
+	//                   request frames read from <file> on ser_rx, each one after the response to the
+	//                   previous one, and finish at the end of <file>. With a named pipe (brlwe_client.py
+	//                   --sim) the simulation stands still while it waits for the next request.
+	// +uartout=<file> : service mode response bytes, one hex byte per line, "# <cycle>" when the
+	//                   service is ready and after each response frame
+	reg [8*256-1:0] uartin_name;
+	reg [8*256-1:0] uartout_name;
+	integer uartin = 0;
+	integer uartout = 0;
+	reg service = 0;
+	event resp_done;
+	integer resp_cnt = 0;
+	integer resp_len = 0;
+
+	task ser_send;
+		input [7:0] data;
+		integer i;
+		begin
+			ser_rx = 0; // start bit
+			repeat (2*ser_half_period) @(posedge clk);
+			for (i = 0; i < 8; i = i + 1) begin
+				ser_rx = data[i];
+				repeat (2*ser_half_period) @(posedge clk);
+			end
+			ser_rx = 1; // stop bit
+			repeat (2*ser_half_period) @(posedge clk);
+		end
+	endtask
+
+	integer req_cmd, req_len, req_byte;
+
+	initial begin
+		if ($value$plusargs("uartin=%s", uartin_name)) begin
+			uartin = $fopen(uartin_name, "r");
+			if ($value$plusargs("uartout=%s", uartout_name))
+				uartout = $fopen(uartout_name, "w");
+			if (!uartin) begin
+				$display("Can not open +uartin file");
+				$finish;
+			end
+
+			wait (leds == 8'h 55);
+			service = 1;
+			$display("\nService ready after %0d cycles", cycle_cnt);
+			if (uartout) begin
+				$fdisplay(uartout, "# %0d", cycle_cnt);
+				$fflush(uartout);
+			end
+
+			forever begin
+				req_cmd = $fgetc(uartin);
+				if (req_cmd < 0) begin
+					$display("\nService done");
+					report_stats;
+					$finish;
+				end
+				ser_send(req_cmd);
+				req_len = $fgetc(uartin);
+				ser_send(req_len);
+				req_byte = $fgetc(uartin);
+				ser_send(req_byte);
+				req_len = req_len | (req_byte << 8);
+				repeat (req_len) begin
+					req_byte = $fgetc(uartin);
+					ser_send(req_byte);
+				end
+				@(resp_done);
+			end
+		end
+	end
+
 	reg [7:0] buffer;
 
 	always begin
@@ -101,6 +200,23 @@ module testbench;
 		repeat (ser_half_period) @(posedge clk);
 		-> ser_sample; // stop bit
 
+		if (service) begin
+			if (uartout)
+				$fdisplay(uartout, "%h", buffer);
+			resp_cnt = resp_cnt + 1;
+			if (resp_cnt == 2)
+				resp_len = buffer;
+			if (resp_cnt == 3)
+				resp_len = resp_len | (buffer << 8);
+			if (resp_cnt >= 3 && resp_cnt == 3 + resp_len) begin
+				if (uartout) begin
+					$fdisplay(uartout, "# %0d", cycle_cnt);
+					$fflush(uartout);
+				end
+				resp_cnt = 0;
+				-> resp_done;
+			end
+		end else
 		/*if (buffer < 32 || buffer >= 127)
 			$write("%d", buffer);
 		else*/
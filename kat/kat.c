@@ -0,0 +1,77 @@
+/*
+ * Host build of the BRLWE library for known answer tests.
+ *
+ * Runs the same key generation / encryption / decryption as the firmware demo
+ * (test vectors from testvec.h, software PRNG from prng.h seeded with RNG_SEED)
+ * and prints the results in the format of kat_print() in firmware.c.
+ * Built and run by "make kat", one .kat file per parameter set.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "params.h"
+#include "prng.h"
+
+void *m_malloc(unsigned nbytes)
+{
+	return malloc(nbytes);
+}
+
+void m_free(void *ap)
+{
+	free(ap);
+}
+
+void setseed32(uint32_t seed)
+{
+	prng_seed(seed);
+}
+
+void getrandom_binary(uint8_t* str)
+{
+	prng_binary(str);
+}
+
+#include "ntt.c"
+#include "brlwe.c"
+#include "testvec.h"
+
+static void kat_print(const char* name, const BRLWE_Ring_polynomials poly)
+{
+	printf("%s =", name);
+	for (int i = 0; i < BRLWE_N; i++)
+		printf(BRLWE_Q > 256 ? " %04x" : " %02x", poly[i]);
+	printf("\n");
+}
+
+int main()
+{
+	BRLWE_Ring_polynomials2 key = m_malloc(BRLWE_N * 2 * 2);
+	BRLWE_Ring_polynomials2 cryptom = m_malloc(BRLWE_N * 2 * 2);
+	BRLWE_Ring_polynomials recoverm = m_malloc(BRLWE_N * 2);
+
+	setseed32(RNG_SEED);
+	BRLWE_Key_Gen((BRLWE_Ring_polynomials) test_1, key);
+	BRLWE_Encry((BRLWE_Ring_polynomials) test_1, key, (void*) test_2, cryptom);
+	BRLWE_Decry(cryptom, key + BRLWE_N, recoverm);
+
+	printf("# BRLWE known answer test: n = %d, q = %d, RNG_SEED = 0x%08x\n", BRLWE_N, BRLWE_Q, RNG_SEED);
+	printf("# a = test_1 and m = test_2 from testvec.h\n");
+	kat_print("pk", key);
+	kat_print("sk", key + BRLWE_N);
+	kat_print("c1", cryptom);
+	kat_print("c2", cryptom + BRLWE_N);
+	kat_print("m", recoverm);
+
+	int errors = 0;
+	for (int i = 0; i < BRLWE_N; i++)
+		errors += recoverm[i] != test_2[i];
+	fprintf(stderr, "n = %d, q = %d: %d decryption errors\n", BRLWE_N, BRLWE_Q, errors);
+
+	free(key);
+	free(cryptom);
+	free(recoverm);
+	return 0;
+}
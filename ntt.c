@@ -2,6 +2,7 @@
 #include "ntt.h"
 
 #include "params.h"
+#include "trace.h"
 
 static const uint32_t qinv = 7679; // -inverse_mod(p,2^18)
 static const uint32_t rlog = 18;
@@ -17,7 +18,7 @@ static const uint32_t rlog = 18;
 *
 * Returns:     unsigned integer in {0,...,2^14-1} congruent to a * R^-1 modulo q.
 **************************************************/
-uint16_t montgomery_reduce(uint32_t a)
+RAMFUNC uint16_t montgomery_reduce(uint32_t a)
 {
 	uint32_t u;
 
@@ -29,128 +30,172 @@ uint16_t montgomery_reduce(uint32_t a)
 }
 
 /*************************************************
-* Name:        coeff_freeze
+* Name:        CSUBQ
 *
-* Description: Fully reduces an integer modulo q in constant time
-*
-* Arguments:   uint16_t x: input integer to be reduced
-*
-* Returns integer in {0,...,q-1} congruent to x modulo q
+* Description: Conditional subtraction of q without a branch;
+*              maps a uint32_t x in {0,...,2q-1} (a montgomery_reduce
+*              output of an input below 2^18 q) to {0,...,q-1}
 **************************************************/
-static uint16_t coeff_freeze(uint16_t x)
-{
-	uint16_t m, r;
-	int16_t c;
-	r = x % NTT_Q;
-
-	m = r - NTT_Q;
-	c = m;
-	c >>= 15;
-	r = m ^ ((r^m)&c);
-
-	return r;
-}
-#if (BRLWE_N == 128)
-
-#if (My_NTT == 1)
-
-#elif (PtNTT == 1)	
-	
-/************************************************************
-* Name:        omegas_bitrev_montgomery
-*
-* Description: Contains powers of 64th root of unity in Montgomery
-*              domain with R=2^18 in bit-reversed order
-************************************************************/
-static const uint16_t omegas_bitrev_montgomery_64[32] = { \
-990, 254, 6819, 2634, 2143, 6586, 7103, 3281,\
-6086, 3858, 5656, 877, 6362, 484, 4345, 5382,\
-1581, 2547, 5932, 5184, 2468, 7678, 3639, 5775,\
-6414, 7418, 4098, 7010, 291, 1285, 538, 7338 };
-
-/************************************************************
-* Name:        omegas_inv_bitrev_montgomery
-*
-* Description: Contains inverses of powers of 64th root of unity
-*              in Montgomery domain with R=2^18 in bit-reversed order
-************************************************************/
-static const uint16_t omegas_inv_bitrev_montgomery_64[32] = { \
-990, 7427, 5047, 862, 4400, 578, 1095, 5538,\
-2299, 3336, 7197, 1319, 6804, 2025, 3823, 1595,\
-343, 7143, 6396, 7390, 671, 3583, 263, 1267,\
-1906, 4042, 3, 5213, 2497, 1749, 5134, 6100 };
-
-/************************************************************
-* Name:        psis_bitrev_montgomery
-*
-* Description: Contains powers of 64th root of -1 in Montgomery
-*              domain with R=2^18 in bit-reversed order
-************************************************************/
-static const uint16_t psis_bitrev_montgomery_64[64] = { \
-990, 254, 6819, 2634, 2143, 6586, 7103, 3281,\
-6086, 3858, 5656, 877, 6362, 484, 4345, 5382,\
-1581, 2547, 5932, 5184, 2468, 7678, 3639, 5775,\
-6414, 7418, 4098, 7010, 291, 1285, 538, 7338,\
-274, 5222, 2539, 2079, 2750, 1559, 6140, 2196,\
-412, 3535, 5724, 491, 2397, 5596, 2056, 4143,\
-4441, 7548, 28, 2552, 6952, 7075, 5383, 6719,\
-5220, 641, 5929, 2716, 5015, 6097, 1142, 7524 };
+#define CSUBQ(x) ((x) - (NTT_Q & -(uint32_t)((x) >= NTT_Q)))
 
+/*************************************************
+* Packed pairs: the NTT butterflies and the pointwise products load
+* and store two uint16_t coefficients as one uint32_t word (coefficient 2i in the low lane,
+* 2i + 1 in the high lane), so the arrays must be 4-byte aligned, as
+* every m_malloc buffer, PtNTT lane and ntt_tables.py table is.
+* PACK_ADD/PACK_SUB add/subtract both 16-bit lanes at once; the carry
+* (borrow) out of bit 15 is masked off, so every lane wraps mod 2^16
+* exactly like the uint16_t stores of the scalar code. Products and
+* reductions still run one lane at a time, so the additions, subtractions
+* and PtNTT base cases that reduce every output stay scalar: there the
+* unpacking costs more than the saved loads
+**************************************************/
+#define PACK_LO 0x7fff7fffu
+#define PACK_HI 0x80008000u
+#define PACK(lo, hi) ((uint32_t)(lo) | (uint32_t)(hi) << 16)
+#define PACK_Q(k) ((k) * NTT_Q * 0x10001u) // k q in both lanes
+#define PACK_ADD(x, y) ((((x) & PACK_LO) + ((y) & PACK_LO)) ^ (((x) ^ (y)) & PACK_HI))
+#define PACK_SUB(x, y) ((((x) | PACK_HI) - ((y) & PACK_LO)) ^ (((x) ^ ~(y)) & PACK_HI))
+#define PACK_MODQ(x) PACK(((x) & 0xffff) % NTT_Q, ((x) >> 16) % NTT_Q)
 
-/************************************************************
-* Name:         psis_inv_montgomery
-*
-* Description: Contains inverses of powers of 64th  root of -1
-*              divided by n in Montgomery domain with R=2^18
-************************************************************/
-static const uint16_t psis_inv_montgomery_64[64] = { \
-4096, 4203, 4926, 5576, 636, 7456, 1710, 2366,\
-1989, 3318, 3971, 5153, 5387, 6681, 7600, 3688, \
-1159, 1945, 580, 3273, 4313, 4090, 7321, 2736, \
-6858, 110, 6845, 1745, 2100, 7083, 6081, 4479, \
-7437, 6463, 3112, 928, 6773, 756, 6544, 7105, \
-7450, 4828, 176, 3271, 2792, 3360, 5188, 5121, \
-4094, 2682, 4196, 3443, 3021, 4692, 4282, 7398, \
-3687, 4239, 1580, 3354, 625, 2931, 5376, 2156 };
+/*************************************************
+* Name:        ntt_packed
+*
+* Description: Forward negacyclic NTT in place, Cooley-Tukey butterflies
+*              with the psi twist merged into the twiddles: input in normal
+*              order, output in bitreversed order, no bitrev or twist pass.
+*              Butterfly block m of the level with distance len uses
+*              zetas[n / (2 len) + m]. Both outputs are lazy (a[j] + 2q - t
+*              for the difference), except on every third level counted
+*              from the last one, which reduces them mod q; so the lanes
+*              stay below 5q + 2q < 2^16 and the output is below q.
+*              Packed pairs: until distance 2, j and j + 1 share the
+*              twiddle, so one word pair carries two butterflies; the last
+*              level butterflies the two lanes of one word
+*
+* Arguments:   - uint16_t * a:          pointer to in/output polynomial, 4-byte aligned
+*              - const uint16_t* zetas: pointer to psis_bitrev_montgomery_<n>
+*              - int logn:              log2 of the number of points (>= 2)
+**************************************************/
+RAMFUNC static void ntt_packed(uint16_t * a, const uint16_t* zetas, int logn)
+{
+	uint32_t *p = (uint32_t *)a;
+	int level, start, j, k, distance, reduce;
+	uint32_t x, y, W;
 
-/************************************************************
-* Name:        bitrev_table
-*
-* Description: Contains bit-reversed 10-bit indices to be used to re-order
-*              polynomials before number theoratic transform
-************************************************************/
-static const uint16_t bitrev_table_64[64] = { \
-0,	32,	16,	48,	8,	40,	24,	56,	4,	36,	20,	52,\
-12,	44,	28,	60,	2,	34,	18,	50,	10,	42,	26,	58,\
-6,	38,	22,	54,	14,	46,	30,	62,	1,	33,	17,	49,\
-9,	41,	25,	57,	5,	37,	21,	53,	13,	45,	29,	61,\
-3,	35,	19,	51,	11,	43,	27,	59,	7,	39,	23,	55,\
-15,	47,	31,	63 };
+	for (level = 0; level < logn - 1; level++)
+	{
+		distance = (1 << logn) >> (level + 2); // in words
+		reduce = ((logn - 1 - level) % 3 == 0);
+		k = 1 << level;
+		for (start = 0; start < (1 << logn) / 2; start += 2 * distance)
+		{
+			W = zetas[k++];
+			for (j = start; j < start + distance; j++)
+			{
+				x = p[j];
+				y = p[j + distance];
+				y = PACK(montgomery_reduce(W * (y & 0xffff)), montgomery_reduce(W * (y >> 16)));
+				p[j] = reduce ? PACK_MODQ(PACK_ADD(x, y)) : PACK_ADD(x, y);
+				y = PACK_SUB(PACK_ADD(x, PACK_Q(2)), y);
+				p[j + distance] = reduce ? PACK_MODQ(y) : y;
+			}
+		}
+	}
+	// Last level (reduces): a[2j], a[2j + 1] are the two lanes of p[j]
+	for (j = 0; j < (1 << logn) / 2; j++)
+	{
+		W = zetas[(1 << logn) / 2 + j];
+		x = p[j];
+		y = montgomery_reduce(W * (x >> 16));
+		x &= 0xffff;
+		p[j] = PACK((x + y) % NTT_Q, (x + 2 * NTT_Q - y) % NTT_Q);
+	}
+}
 
 /*************************************************
-* Name:        bitrev_vector
-*
-* Description: Permutes coefficients of a polynomial into bitreversed order
-*
-* Arguments:   - uint16_t* poly: pointer to in/output polynomial
+* Name:        invntt_packed
+*
+* Description: Inverse of ntt_packed in place, Gentleman-Sande butterflies
+*              with the inverse psi twist merged into the twiddles: input in
+*              bitreversed order, output in normal order, no bitrev or twist
+*              pass. Block m of the level with distance len uses
+*              zetas_inv[n / (2 len) + m]; even levels are lazy, odd levels
+*              reduce a[j] mod q. The last level also scales by n^-1
+*              (zetas_inv[0], and zetas_inv[1] comes scaled), so every output
+*              leaves one montgomery_reduce and CSUBQ fully reduced.
+*              Packed pairs as in ntt_packed, in the opposite level order
+*
+* Arguments:   - uint16_t * a:              pointer to in/output polynomial, 4-byte aligned
+*              - const uint16_t* zetas_inv: pointer to psis_inv_bitrev_montgomery_<n>
+*              - int logn:                  log2 of the number of points (>= 2)
 **************************************************/
-void bitrev_vector_64(uint16_t* poly)
+RAMFUNC static void invntt_packed(uint16_t * a, const uint16_t* zetas_inv, int logn)
 {
-	unsigned int i, r;
-	uint16_t tmp;
+	uint32_t *p = (uint32_t *)a;
+	int level, start, j, k, distance;
+	uint32_t x, y, s, W, lo, hi;
 
-	for (i = 0; i < 64; i++)
+	// Level 0 (even, lazy): a[2j], a[2j + 1] are the two lanes of p[j]
+	for (j = 0; j < (1 << logn) / 2; j++)
 	{
-		r = bitrev_table_64[i];
-		if (i < r)
+		W = zetas_inv[(1 << logn) / 2 + j];
+		x = p[j];
+		y = x >> 16;
+		x &= 0xffff;
+		p[j] = PACK(x + y, montgomery_reduce(W * (x + 3 * NTT_Q - y)));
+	}
+	for (level = 1; level < logn - 1; level++)
+	{
+		distance = 1 << (level - 1); // in words
+		k = (1 << logn) >> (level + 1);
+		for (start = 0; start < (1 << logn) / 2; start += 2 * distance)
 		{
-			tmp = poly[i];
-			poly[i] = poly[r];
-			poly[r] = tmp;
+			W = zetas_inv[k++];
+			for (j = start; j < start + distance; j++)
+			{
+				x = p[j];
+				y = p[j + distance];
+				p[j] = (level & 1) ? PACK_MODQ(PACK_ADD(x, y)) : PACK_ADD(x, y); // odd levels reduce, even are lazy
+				y = PACK_SUB(PACK_ADD(x, PACK_Q(3)), y);
+				p[j + distance] = PACK(montgomery_reduce(W * (y & 0xffff)), montgomery_reduce(W * (y >> 16)));
+			}
 		}
 	}
+	// Last level, times n^-1
+	distance = (1 << logn) / 4;
+	for (j = 0; j < distance; j++)
+	{
+		x = p[j];
+		y = p[j + distance];
+		s = PACK_ADD(x, y);
+		lo = montgomery_reduce(zetas_inv[0] * (s & 0xffff));
+		hi = montgomery_reduce(zetas_inv[0] * (s >> 16));
+		p[j] = PACK(CSUBQ(lo), CSUBQ(hi));
+		y = PACK_SUB(PACK_ADD(x, PACK_Q(3)), y);
+		lo = montgomery_reduce(zetas_inv[1] * (y & 0xffff));
+		hi = montgomery_reduce(zetas_inv[1] * (y >> 16));
+		p[j + distance] = PACK(CSUBQ(lo), CSUBQ(hi));
+	}
 }
 
+#if (BRLWE_N == 128)
+
+#if (My_NTT == 1)
+
+#elif (PtNTT == 1)	
+	
+/************************************************************
+* Twiddle tables of the 64-point NTT (psis_bitrev_montgomery_64,
+* psis_inv_bitrev_montgomery_64, ptntt_roots_montgomery_64),
+* generated by ntt_tables.py (see the Makefile)
+************************************************************/
+#include "ntt_tables_64.h"
+
+#if (NTT_64_Q != NTT_Q) || (NTT_64_RLOG != 18)
+#error "ntt_tables_64.h was generated for another q or R, see NTT_TABLES_Q/NTT_TABLES_RLOG in the Makefile"
+#endif
+
 /*************************************************
 * Name:        get_int16_polys
 *
@@ -170,70 +215,39 @@ void get_int16_polys(uint16_t *arr, uint16_t *poly) {
 };
 
 /*************************************************
-* Name:        mul_coefficients
+* Name:        ntt_64
 *
-* Description: Performs pointwise (coefficient-wise) multiplication
-*              of two polynomials
-* Arguments:   - uint16_t* poly:          pointer to in/output polynomial
-*              - const uint16_t* factors: pointer to input polynomial, coefficients
-*                                         are assumed to be in Montgomery representation
+* Description: Computes negacyclic number-theoretic transform (NTT) of
+*              a polynomial in place; input in normal order, output
+*              in bitreversed order (see ntt_packed)
+*
+* Arguments:   - uint16_t * a:          pointer to in/output polynomial
+*              - const uint16_t* zetas: pointer to input twiddles with the psi twist merged;
+*                                       assumed to be in Montgomery domain
 **************************************************/
-void mul_coefficients_64(uint16_t* poly, const uint16_t* factors)
+RAMFUNC void ntt_64(uint16_t * a, const uint16_t* zetas)
 {
-	unsigned int i;
-
-	for (i = 0; i < 64; i++)
-		poly[i] = montgomery_reduce((poly[i] * factors[i]));
+	TRACE(TRACE_NTT_64);
+	ntt_packed(a, zetas, 6); // 1<<6 = 64
+	TRACE(TRACE_NTT_64 | TRACE_END);
 }
 
 /*************************************************
-* Name:        ntt_64
+* Name:        invntt_64
 *
-* Description: Computes number-theoretic transform (NTT) of
-*              a polynomial in place; inputs assumed to be in
-*              bitreversed order, output in normal order
+* Description: Inverse of ntt_64 in place, scaling included; input in
+*              bitreversed order, output in normal order and reduced mod q
+*              (see invntt_packed)
 *
-* Arguments:   - uint16_t * a:          pointer to in/output polynomial
-*              - const uint16_t* omega: pointer to input powers of root of unity omega;
-*                                       assumed to be in Montgomery domain
+* Arguments:   - uint16_t * a:              pointer to in/output polynomial
+*              - const uint16_t* zetas_inv: pointer to input inverse twiddles with the psi twist merged;
+*                                           assumed to be in Montgomery domain
 **************************************************/
-void ntt_64(uint16_t * a, const uint16_t* omega)
+RAMFUNC void invntt_64(uint16_t * a, const uint16_t* zetas_inv)
 {
-	int i, start, j, jTwiddle, distance;
-	uint16_t temp, W;
-
-
-	for (i = 0; i < 6; i += 2) // 1<<6 = 64 
-	{
-		// Even level
-		distance = (1 << i);
-		for (start = 0; start < distance; start++)
-		{
-			jTwiddle = 0;
-			for (j = start; j < 63; j += 2 * distance)
-			{
-				W = omega[jTwiddle++];
-				temp = a[j];
-				a[j] = (temp + a[j + distance]); // Omit reduction (be lazy)
-				a[j + distance] = montgomery_reduce((W * ((uint32_t)temp + 3 * 7681 - a[j + distance])));
-			}
-		}
-		if (i + 1 < 6) { // 1<<6 = 64 
-			// Odd level
-			distance <<= 1;
-			for (start = 0; start < distance; start++)
-			{
-				jTwiddle = 0;
-				for (j = start; j < 63; j += 2 * distance)
-				{
-					W = omega[jTwiddle++];
-					temp = a[j];
-					a[j] = (temp + a[j + distance]) % 7681;
-					a[j + distance] = montgomery_reduce((W * ((uint32_t)temp + 3 * 7681 - a[j + distance])));
-				}
-			}
-		}
-	}
+	TRACE(TRACE_NTT_64);
+	invntt_packed(a, zetas_inv, 6);
+	TRACE(TRACE_NTT_64 | TRACE_END);
 }
 
 /*************************************************
@@ -248,11 +262,13 @@ void ntt_64(uint16_t * a, const uint16_t* omega)
 void poly_quarter_mul_pointwise(uint16_t *r, const uint16_t *a, const uint16_t *b)
 {
 	int i;
-	uint16_t t;
-	for (i = 0; i < 64; i++)
+	uint32_t x, y;
+	for (i = 0; i < 32; i++) // packed pairs
 	{
-		t = montgomery_reduce(4613 * b[i]); /* t is now in Montgomery domain */
-		r[i] = montgomery_reduce(a[i] * t);  /* r->coeffs[i] is back in normal domain */
+		x = ((const uint32_t *)a)[i];
+		y = ((const uint32_t *)b)[i];
+		y = PACK(montgomery_reduce(4613 * (y & 0xffff)), montgomery_reduce(4613 * (y >> 16))); /* y is now in Montgomery domain */
+		((uint32_t *)r)[i] = PACK(montgomery_reduce((x & 0xffff) * (y & 0xffff)), montgomery_reduce((x >> 16) * (y >> 16))); /* back in normal domain */
 	}
 }
 /*************************************************
@@ -403,15 +419,14 @@ int recover_poly(uint16_t *f, struct ptpoly4 poly)
 * Name:        poly_ntt
 *
 * Description: Forward NTT transform of a polynomial in place
-*              Input is assumed to have coefficients in bitreversed order
-*              Output has coefficients in normal order
+*              Input has coefficients in normal order
+*              Output has coefficients in bitreversed order
 *
 * Arguments:   - poly *r: pointer to in/output polynomial
 **************************************************/
 void poly_ntt_64(uint16_t *r)
 {
-	mul_coefficients_64(r, psis_bitrev_montgomery_64);
-	ntt_64(r, omegas_bitrev_montgomery_64);
+	ntt_64(r, psis_bitrev_montgomery_64);
 }
 
 
@@ -419,32 +434,22 @@ void poly_ntt_64(uint16_t *r)
 * Name:        poly_invntt_128
 *
 * Description: Inverse NTT transform of a polynomial in place
-*              Input is assumed to have coefficients in normal order
+*              Input has coefficients in bitreversed order
 *              Output has coefficients in normal order
 *
 * Arguments:   - poly *r: pointer to in/output polynomial
 **************************************************/
 void poly_invntt_64(uint16_t *r)
 {
-	bitrev_vector_64(r);
-	ntt_64((uint16_t *)r, omegas_inv_bitrev_montgomery_64);
-	mul_coefficients_64(r, psis_inv_montgomery_64);
-	for (int i = 0; i < 63; i++)
-	{
-		r[i] = coeff_freeze(r[i]);
-	}
-	
+	TRACE(TRACE_INVNTT_64);
+	invntt_64(r, psis_inv_bitrev_montgomery_64);
+	TRACE(TRACE_INVNTT_64 | TRACE_END);
 }
 
 void poly_pt_ntt4(uint16_t *p, struct ptpoly4 poly)
 {
 	split_poly(p, poly);
 
-	bitrev_vector_64(poly.poly00);
-	bitrev_vector_64(poly.poly10);
-	bitrev_vector_64(poly.poly01);
-	bitrev_vector_64(poly.poly11);
-
 	poly_ntt_64(poly.poly00);
 	poly_ntt_64(poly.poly10);
 	poly_ntt_64(poly.poly01);
@@ -458,20 +463,11 @@ void poly_pt_ntt7(uint16_t *p, struct ptpoly7 poly)
 	shift_poly(poly.poly01_s, poly.poly4.poly01);
 	shift_poly(poly.poly11_s, poly.poly4.poly11);
 
-	bitrev_vector_64(poly.poly4.poly00);
-	bitrev_vector_64(poly.poly4.poly10);
-	bitrev_vector_64(poly.poly4.poly01);
-	bitrev_vector_64(poly.poly4.poly11);
-
 	poly_ntt_64(poly.poly4.poly00);
 	poly_ntt_64(poly.poly4.poly10);
 	poly_ntt_64(poly.poly4.poly01);
 	poly_ntt_64(poly.poly4.poly11);
 
-	bitrev_vector_64(poly.poly01_s);
-	bitrev_vector_64(poly.poly10_s);
-	bitrev_vector_64(poly.poly11_s);
-
 	poly_ntt_64(poly.poly01_s);
 	poly_ntt_64(poly.poly10_s);
 	poly_ntt_64(poly.poly11_s);
@@ -563,24 +559,26 @@ void pt_ntt_bowtiemultiply(uint16_t *b, struct ptpoly4 f, struct ptpoly7 g)
 	split_poly(f, f00, f01, f10, f11);*/
 
 	int i;
-	uint32_t t1, t2, t3, t4;
+	uint32_t f00, f01, f10, f11, t;
+	TRACE(TRACE_BOWTIE);
 	for (i = 0; i < 64; i++)
 	{
+		/* every f lane into Montgomery domain once per index (4613 = R^2 mod q); the four
+		   products of an output are summed unreduced (< 2^28 each) and brought back to
+		   the normal domain by one montgomery_reduce and one conditional subtraction */
+		f00 = montgomery_reduce(4613 * f.poly00[i]);
+		f01 = montgomery_reduce(4613 * f.poly01[i]);
+		f10 = montgomery_reduce(4613 * f.poly10[i]);
+		f11 = montgomery_reduce(4613 * f.poly11[i]);
+
 		/*poly_quarter_mul_pointwise(temp0, f00, g00);
 		poly_quarter_mul_pointwise(temp1, f01, g01_s);
 		poly_quarter_mul_pointwise(temp2, f10, g11_s);
 		poly_quarter_mul_pointwise(temp3, f11, g10_s);
 		poly_quarter_add(b00, temp0, temp1, temp2, temp3);*/
 
-		t1 = montgomery_reduce(4613 * f.poly00[i]);
-		t1 = montgomery_reduce(g.poly4.poly00[i] * t1); 
-		t2 = montgomery_reduce(4613 * f.poly01[i]); 
-		t2 = montgomery_reduce(g.poly01_s[i] * t2); 
-		t3 = montgomery_reduce(4613 * f.poly10[i]); 
-		t3 = montgomery_reduce(g.poly11_s[i] * t3); 
-		t4 = montgomery_reduce(4613 * f.poly11[i]); 
-		t4 = montgomery_reduce(g.poly10_s[i] * t4);
-		b[4 * i] = (t1 + t2 + t3 + t4) % NTT_Q;
+		t = montgomery_reduce(g.poly4.poly00[i] * f00 + g.poly01_s[i] * f01 + g.poly11_s[i] * f10 + g.poly10_s[i] * f11);
+		b[4 * i] = CSUBQ(t);
 
 		/*poly_quarter_mul_pointwise(temp0, f00, g10);
 		poly_quarter_mul_pointwise(temp1, f01, g11_s);
@@ -588,15 +586,8 @@ void pt_ntt_bowtiemultiply(uint16_t *b, struct ptpoly4 f, struct ptpoly7 g)
 		poly_quarter_mul_pointwise(temp3, f11, g01_s);
 		poly_quarter_add(b10, temp0, temp1, temp2, temp3);*/
 
-		t1 = montgomery_reduce(4613 * f.poly00[i]);
-		t1 = montgomery_reduce(g.poly4.poly10[i] * t1);
-		t2 = montgomery_reduce(4613 * f.poly01[i]);
-		t2 = montgomery_reduce(g.poly11_s[i] * t2);
-		t3 = montgomery_reduce(4613 * f.poly10[i]);
-		t3 = montgomery_reduce(g.poly4.poly00[i] * t3);
-		t4 = montgomery_reduce(4613 * f.poly11[i]);
-		t4 = montgomery_reduce(g.poly01_s[i] * t4);
-		b[4 * i + 1] = (t1 + t2 + t3 + t4) % NTT_Q;
+		t = montgomery_reduce(g.poly4.poly10[i] * f00 + g.poly11_s[i] * f01 + g.poly4.poly00[i] * f10 + g.poly01_s[i] * f11);
+		b[4 * i + 1] = CSUBQ(t);
 
 		/*poly_quarter_mul_pointwise(temp0, f00, g01);
 		poly_quarter_mul_pointwise(temp1, f01, g00);
@@ -604,15 +595,8 @@ void pt_ntt_bowtiemultiply(uint16_t *b, struct ptpoly4 f, struct ptpoly7 g)
 		poly_quarter_mul_pointwise(temp3, f11, g11_s);
 		poly_quarter_add(b01, temp0, temp1, temp2, temp3);*/
 
-		t1 = montgomery_reduce(4613 * f.poly00[i]);
-		t1 = montgomery_reduce(g.poly4.poly01[i] * t1);
-		t2 = montgomery_reduce(4613 * f.poly01[i]);
-		t2 = montgomery_reduce(g.poly4.poly00[i] * t2);
-		t3 = montgomery_reduce(4613 * f.poly10[i]);
-		t3 = montgomery_reduce(g.poly4.poly10[i] * t3);
-		t4 = montgomery_reduce(4613 * f.poly11[i]);
-		t4 = montgomery_reduce(g.poly11_s[i] * t4);
-		b[4 * i + 2] = (t1 + t2 + t3 + t4) % NTT_Q;
+		t = montgomery_reduce(g.poly4.poly01[i] * f00 + g.poly4.poly00[i] * f01 + g.poly4.poly10[i] * f10 + g.poly11_s[i] * f11);
+		b[4 * i + 2] = CSUBQ(t);
 
 		/*poly_quarter_mul_pointwise(temp0, f00, g11);
 		poly_quarter_mul_pointwise(temp1, f01, g10);
@@ -620,17 +604,11 @@ void pt_ntt_bowtiemultiply(uint16_t *b, struct ptpoly4 f, struct ptpoly7 g)
 		poly_quarter_mul_pointwise(temp3, f11, g00);
 		poly_quarter_add(b11, temp0, temp1, temp2, temp3);*/
 
-		t1 = montgomery_reduce(4613 * f.poly00[i]);
-		t1 = montgomery_reduce(g.poly4.poly11[i] * t1);
-		t2 = montgomery_reduce(4613 * f.poly01[i]);
-		t2 = montgomery_reduce(g.poly4.poly10[i] * t2);
-		t3 = montgomery_reduce(4613 * f.poly10[i]);
-		t3 = montgomery_reduce(g.poly4.poly01[i] * t3);
-		t4 = montgomery_reduce(4613 * f.poly11[i]);
-		t4 = montgomery_reduce(g.poly4.poly00[i] * t4);
-		b[4 * i + 3] = (t1 + t2 + t3 + t4) % NTT_Q;
+		t = montgomery_reduce(g.poly4.poly11[i] * f00 + g.poly4.poly10[i] * f01 + g.poly4.poly01[i] * f10 + g.poly4.poly00[i] * f11);
+		b[4 * i + 3] = CSUBQ(t);
 
 	}
+	TRACE(TRACE_BOWTIE | TRACE_END);
 	/*
 	free(f00);
 	free(f01);
@@ -662,138 +640,260 @@ void poly_inv_ptntt(uint16_t *b)
 	free(n.poly11);
 }
 
+/*************************************************
+* In-place PtNTT (PTNTT_INPLACE), split factor k = PTNTT_SPLIT:
+* x^128 + 1 = y^M + 1 with y = x^k and M = PTNTT_M = 128 / k, so lane u
+* (the coefficients u, u + k, u + 2k, ..) is one M-point negacyclic NTT,
+* stored at r[u * M .. u * M + M - 1]. Slot j of every lane evaluates y
+* at ptntt_roots[j] (slots in bitreversed order, as the forward NTT leaves
+* them); the base case multiplies mod x^k - y in each slot.
+* k = 2 runs on the 64-point kernels above; k = 4 and 8 on the 32- and
+* 16-point tables of ntt_tables.py and the generic kernels below
+**************************************************/
+#if (PTNTT_SPLIT == 2)
+
+#define ptntt_roots        ptntt_roots_montgomery_64
+#define poly_ntt_pt        poly_ntt_64
+#define poly_invntt_pt     poly_invntt_64
+
+#else
+
+#if (PTNTT_SPLIT == 4)
+#include "ntt_tables_32.h"
+#define PTNTT_LOG          5
+#define ptntt_psis         psis_bitrev_montgomery_32
+#define ptntt_psis_inv     psis_inv_bitrev_montgomery_32
+#define ptntt_roots        ptntt_roots_montgomery_32
+#if (NTT_32_Q != NTT_Q) || (NTT_32_RLOG != 18)
+#error "ntt_tables_32.h was generated for another q or R, see NTT_TABLES_Q/NTT_TABLES_RLOG in the Makefile"
+#endif
+#elif (PTNTT_SPLIT == 8)
+#include "ntt_tables_16.h"
+#define PTNTT_LOG          4
+#define ptntt_psis         psis_bitrev_montgomery_16
+#define ptntt_psis_inv     psis_inv_bitrev_montgomery_16
+#define ptntt_roots        ptntt_roots_montgomery_16
+#if (NTT_16_Q != NTT_Q) || (NTT_16_RLOG != 18)
+#error "ntt_tables_16.h was generated for another q or R, see NTT_TABLES_Q/NTT_TABLES_RLOG in the Makefile"
+#endif
 #endif
 
-#elif (BRLWE_N == 256)
-
-
-/************************************************************
-* Name:        omegas_bitrev_montgomery
+/*************************************************
+* Name:        ntt_pt
 *
-* Description: Contains powers of 256th root of unity in Montgomery
-*              domain with R=2^18 in bit-reversed order
-************************************************************/
-static const uint16_t omegas_bitrev_montgomery[128] = {
-  990, 7427, 2634, 6819, 578, 3281, 2143, 1095, 484, 6362, 3336, 5382, 6086, 3823, 877, 5656,
-  3583, 7010, 6414, 263, 1285, 291, 7143, 7338, 1581, 5134, 5184, 5932, 4042, 5775, 2468, 3,
-  606, 729, 5383, 962, 3240, 7548, 5129, 7653, 5929, 4965, 2461, 641, 1584, 2666, 1142, 157,
-  7407, 5222, 5602, 5142, 6140, 5485, 4931, 1559, 2085, 5284, 2056, 3538, 7269, 3535, 7190, 1957,
-  3465, 6792, 1538, 4664, 2023, 7643, 3660, 7673, 1694, 6905, 3995, 3475, 5939, 1859, 6910, 4434,
-  1019, 1492, 7087, 4761, 657, 4859, 5798, 2640, 1693, 2607, 2782, 5400, 6466, 1010, 957, 3851,
-  2121, 6392, 7319, 3367, 3659, 3375, 6430, 7583, 1549, 5856, 4773, 6084, 5544, 1650, 3997, 4390,
-  6722, 2915, 4245, 2635, 6128, 7676, 5737, 1616, 3457, 3132, 7196, 4702, 6239, 851, 2122, 3009
-};
-
-/************************************************************
-* Name:         omegas_inv_bitrev_montgomery
+* Description: ntt_64 for PTNTT_M points; input in normal order, output
+*              in bitreversed order
 *
-* Description: Contains inverses of powers of 256th root of unity
-*              in Montgomery domain with R=2^18 in bit-reversed order
-************************************************************/
-static const uint16_t omegas_inv_bitrev_montgomery[128] = {
-  990, 254, 862, 5047, 6586, 5538, 4400, 7103, 2025, 6804, 3858, 1595, 2299, 4345, 1319, 7197,
-  7678, 5213, 1906, 3639, 1749, 2497, 2547, 6100, 343, 538, 7390, 6396, 7418, 1267, 671, 4098,
-  5724, 491, 4146, 412, 4143, 5625, 2397, 5596, 6122, 2750, 2196, 1541, 2539, 2079, 2459, 274,
-  7524, 6539, 5015, 6097, 7040, 5220, 2716, 1752, 28, 2552, 133, 4441, 6719, 2298, 6952, 7075,
-  4672, 5559, 6830, 1442, 2979, 485, 4549, 4224, 6065, 1944, 5, 1553, 5046, 3436, 4766, 959,
-  3291, 3684, 6031, 2137, 1597, 2908, 1825, 6132, 98, 1251, 4306, 4022, 4314, 362, 1289, 5560,
-  3830, 6724, 6671, 1215, 2281, 4899, 5074, 5988, 5041, 1883, 2822, 7024, 2920, 594, 6189, 6662,
-  3247, 771, 5822, 1742, 4206, 3686, 776, 5987, 8, 4021, 38, 5658, 3017, 6143, 889, 4216
-};
+* Arguments:   - uint16_t * a:          pointer to in/output polynomial
+*              - const uint16_t* zetas: pointer to input twiddles with the psi twist merged;
+*                                       assumed to be in Montgomery domain
+**************************************************/
+RAMFUNC void ntt_pt(uint16_t * a, const uint16_t* zetas)
+{
+	TRACE(TRACE_NTT_PT);
+	ntt_packed(a, zetas, PTNTT_LOG);
+	TRACE(TRACE_NTT_PT | TRACE_END);
+}
 
-/************************************************************
-* Name:        psis_bitrev_montgomery
+/*************************************************
+* Name:        invntt_pt
 *
-* Description: Contains powers of 256th root of -1 in Montgomery
-*              domain with R=2^18 in bit-reversed order
-************************************************************/
-static const uint16_t psis_bitrev_montgomery[256] = {
-  990, 7427, 2634, 6819, 578, 3281, 2143, 1095, 484, 6362, 3336, 5382, 6086, 3823, 877, 5656,
-  3583, 7010, 6414, 263, 1285, 291, 7143, 7338, 1581, 5134, 5184, 5932, 4042, 5775, 2468, 3,
-  606, 729, 5383, 962, 3240, 7548, 5129, 7653, 5929, 4965, 2461, 641, 1584, 2666, 1142, 157,
-  7407, 5222, 5602, 5142, 6140, 5485, 4931, 1559, 2085, 5284, 2056, 3538, 7269, 3535, 7190, 1957,
-  3465, 6792, 1538, 4664, 2023, 7643, 3660, 7673, 1694, 6905, 3995, 3475, 5939, 1859, 6910, 4434,
-  1019, 1492, 7087, 4761, 657, 4859, 5798, 2640, 1693, 2607, 2782, 5400, 6466, 1010, 957, 3851,
-  2121, 6392, 7319, 3367, 3659, 3375, 6430, 7583, 1549, 5856, 4773, 6084, 5544, 1650, 3997, 4390,
-  6722, 2915, 4245, 2635, 6128, 7676, 5737, 1616, 3457, 3132, 7196, 4702, 6239, 851, 2122, 3009,
-  7613, 7295, 2007, 323, 5112, 3716, 2289, 6442, 6965, 2713, 7126, 3401, 963, 6596, 607, 5027,
-  7078, 4484, 5937, 944, 2860, 2680, 5049, 1777, 5850, 3387, 6487, 6777, 4812, 4724, 7077, 186,
-  6848, 6793, 3463, 5877, 1174, 7116, 3077, 5945, 6591, 590, 6643, 1337, 6036, 3991, 1675, 2053,
-  6055, 1162, 1679, 3883, 4311, 2106, 6163, 4486, 6374, 5006, 4576, 4288, 5180, 4102, 282, 6119,
-  7443, 6330, 3184, 4971, 2530, 5325, 4171, 7185, 5175, 5655, 1898, 382, 7211, 43, 5965, 6073,
-  1730, 332, 1577, 3304, 2329, 1699, 6150, 2379, 5113, 333, 3502, 4517, 1480, 1172, 5567, 651,
-  925, 4573, 599, 1367, 4109, 1863, 6929, 1605, 3866, 2065, 4048, 839, 5764, 2447, 2022, 3345,
-  1990, 4067, 2036, 2069, 3567, 7371, 2368, 339, 6947, 2159, 654, 7327, 2768, 6676, 987, 2214
-};
+* Description: invntt_64 for PTNTT_M points; input in bitreversed order,
+*              output in normal order and reduced mod q
+*
+* Arguments:   - uint16_t * a:              pointer to in/output polynomial
+*              - const uint16_t* zetas_inv: pointer to input inverse twiddles with the psi twist merged;
+*                                           assumed to be in Montgomery domain
+**************************************************/
+RAMFUNC void invntt_pt(uint16_t * a, const uint16_t* zetas_inv)
+{
+	TRACE(TRACE_NTT_PT);
+	invntt_packed(a, zetas_inv, PTNTT_LOG);
+	TRACE(TRACE_NTT_PT | TRACE_END);
+}
 
-/************************************************************
-* Name:        psis_inv_montgomery
+/*************************************************
+* Name:        poly_ntt_pt
 *
-* Description: Contains inverses of powers of 256th  root of -1
-*              divided by n in Montgomery domain with R=2^18
-************************************************************/
-static const uint16_t psis_inv_montgomery[256] = {
-  1024, 4972, 5779, 6907, 4943, 4168,  315, 5580,   90,  497, 1123,  142, 4710, 5527, 2443, 4871,
-   698, 2489, 2394, 4003,  684, 2241, 2390, 7224, 5072, 2064, 4741, 1687, 6841,  482, 7441, 1235,
-  2126, 4742, 2802, 5744, 6287, 4933,  699, 3604, 1297, 2127, 5857, 1705, 3868, 3779, 4397, 2177,
-   159,  622, 2240, 1275,  640, 6948, 4572, 5277,  209, 2605, 1157, 7328, 5817, 3191, 1662, 2009,
-  4864,  574, 2487,  164, 6197, 4436, 7257, 3462, 4268, 4281, 3414, 4515, 3170, 1290, 2003, 5855,
-  7156, 6062, 7531, 1732, 3249, 4884, 7512, 3590, 1049, 2123, 1397, 6093, 3691, 6130, 6541, 3946,
-  6258, 3322, 1788, 4241, 4900, 2309, 1400, 1757,  400,  502, 6698, 2338, 3011,  668, 7444, 4580,
-  6516, 6795, 2959, 4136, 3040, 2279, 6355, 3943, 2913, 6613, 7416, 4084, 6508, 5556, 4054, 3782,
-	61, 6567, 2212,  779,  632, 5709, 5667, 4923, 4911, 6893, 4695, 4164, 3536, 2287, 7594, 2848,
-  3267, 1911, 3128,  546, 1991,  156, 4958, 5531, 6903,  483,  875,  138,  250, 2234, 2266, 7222,
-  2842, 4258,  812, 6703,  232, 5207, 6650, 2585, 1900, 6225, 4932, 7265, 4701, 3173, 4635, 6393,
-   227, 7313, 4454, 4284, 6759, 1224, 5223, 1447,  395, 2608, 4502, 4037,  189, 3348,   54, 6443,
-  2210, 6230, 2826, 1780, 3002, 5995, 1955, 6102, 6045, 3938, 5019, 4417, 1434, 1262, 1507, 5847,
-  5917, 7157, 7177, 6434, 7537,  741, 4348, 1309,  145,  374, 2236, 4496, 5028, 6771, 6923, 7421,
-  1978, 1023, 3857, 6876, 1102, 7451, 4704, 6518, 1344,  765,  384, 5705, 1207, 1630, 4734, 1563,
-  6839, 5933, 1954, 4987, 7142, 5814, 7527, 4953, 7637, 4707, 2182, 5734, 2818,  541, 4097, 5641
-};
+* Description: Forward NTT of one PTNTT_M point lane in place
+*              Input has coefficients in normal order
+*              Output has coefficients in bitreversed order
+*
+* Arguments:   - uint16_t *r: pointer to in/output lane
+**************************************************/
+void poly_ntt_pt(uint16_t *r)
+{
+	ntt_pt(r, ptntt_psis);
+}
 
-static const uint16_t bitrev_table_256[256] = {
-0,128,64,192,32,160,96,224,16,144,80,208,48,176,112,240,
-	 8,136,72,200,40,168,104,232,24,152,88,216,56,184,120,248,
-	 4,132,68,196,36,164,100,228,20,148,84,212,52,180,116,244,
-	 12,140,76,204,44,172,108,236,28,156,92,220,60,188,124,252,
-	 2,130,66,194,34,162,98,226,18,146,82,210,50,178,114,242,
-	 10,138,74,202,42,170,106,234,26,154,90,218,58,186,122,250,
-	 6,134,70,198,38,166,102,230,22,150,86,214,54,182,118,246,
-	 14,142,78,206,46,174,110,238,30,158,94,222,62,190,126,254,
-	 1,129,65,193,33,161,97,225,17,145,81,209,49,177,113,241,
-	 9,137,73,201,41,169,105,233,25,153,89,217,57,185,121,249,
-	 5,133,69,197,37,165,101,229,21,149,85,213,53,181,117,245,
-	 13,141,77,205,45,173,109,237,29,157,93,221,61,189,125,253,
-	 3,131,67,195,35,163,99,227,19,147,83,211,51,179,115,243,
-	 11,139,75,203,43,171,107,235,27,155,91,219,59,187,123,251,
-	 7,135,71,199,39,167,103,231,23,151,87,215,55,183,119,247,
-	 15,143,79,207,47,175,111,239,31,159,95,223,63,191,127,255 };
+/*************************************************
+* Name:        poly_invntt_pt
+*
+* Description: Inverse NTT of one PTNTT_M point lane in place
+*              Input has coefficients in bitreversed order
+*              Output has coefficients in normal order
+*
+* Arguments:   - uint16_t *r: pointer to in/output lane
+**************************************************/
+void poly_invntt_pt(uint16_t *r)
+{
+	invntt_pt(r, ptntt_psis_inv);
+}
 
+#endif
 
 /*************************************************
-* Name:        bitrev_vector
+* Name:        poly_pt_ntt_split
 *
-* Description: Permutes coefficients of a polynomial into bitreversed order
+* Description: Forward in-place PtNTT of an N = 128 polynomial without zero
+*              padding: coefficient k i + u goes to slot i of lane u
 *
-* Arguments:   - uint16_t* poly: pointer to in/output polynomial
+* Arguments:   - uint16_t *r:       pointer to output, PTNTT_SPLIT lanes of PTNTT_M
+*              - const uint16_t *p: pointer to input polynomial with N coefficients, not r
 **************************************************/
+void poly_pt_ntt_split(uint16_t *r, const uint16_t *p)
+{
+	int i, u;
+	for (i = 0; i < PTNTT_M; i++)
+		for (u = 0; u < PTNTT_SPLIT; u++)
+			r[u * PTNTT_M + i] = p[PTNTT_SPLIT * i + u];
+	for (u = 0; u < PTNTT_SPLIT; u++)
+		poly_ntt_pt(r + u * PTNTT_M);
+}
 
-void bitrev_vector_256(uint16_t* poly)
+/*************************************************
+* Name:        pt_ntt_basemul2/4/8
+*
+* Description: Base case of the in-place PtNTT for k = 2, 4, 8: in every
+*              slot, (f0 + .. + x^(k-1) f(k-1)) (g0 + ..) mod x^k - y, i.e.
+*              r_t = sum(u+v = t) fu gv + y sum(u+v = t+k) fu gv, with y from
+*              ptntt_roots. The f lanes are brought into Montgomery domain
+*              once per slot, the products of an output are summed unreduced
+*              and reduced once (twice for the y term). Slot i is read before
+*              it is written, so r may be f or g. pt_ntt_basemul() in ntt.h
+*              picks the one for PTNTT_SPLIT
+*
+* Arguments:   - uint16_t *r:       pointer to output (N coefficients, NTT domain)
+*              - const uint16_t *f: pointer to first input, from poly_pt_ntt_split
+*              - const uint16_t *g: pointer to second input, from poly_pt_ntt_split
+**************************************************/
+#if (PTNTT_SPLIT == 2)
+void pt_ntt_basemul2(uint16_t *r, const uint16_t *f, const uint16_t *g)
 {
-	unsigned int i, r;
-	uint16_t tmp;
+	int i;
+	uint32_t f0, f1, g0, g1, t;
+	TRACE(TRACE_PT_BASEMUL);
+	for (i = 0; i < 64; i++)
+	{
+		f0 = montgomery_reduce(4613 * f[i]); /* f0, f1 are now in Montgomery domain */
+		f1 = montgomery_reduce(4613 * f[i + 64]);
+		g0 = g[i];
+		g1 = g[i + 64];
+		t = montgomery_reduce(g1 * f1); /* normal domain, times y (Montgomery domain) below */
+		t = montgomery_reduce(g0 * f0 + t * ptntt_roots[i]);
+		r[i] = CSUBQ(t);
+		t = montgomery_reduce(g1 * f0 + g0 * f1);
+		r[i + 64] = CSUBQ(t);
+	}
+	TRACE(TRACE_PT_BASEMUL | TRACE_END);
+}
 
-	for (i = 0; i < 256; i++)
+#elif (PTNTT_SPLIT == 4)
+void pt_ntt_basemul4(uint16_t *r, const uint16_t *f, const uint16_t *g)
+{
+	int i;
+	uint32_t f0, f1, f2, f3, g0, g1, g2, g3, t;
+	TRACE(TRACE_PT_BASEMUL);
+	for (i = 0; i < 32; i++)
 	{
-		r = bitrev_table_256[i];
-		if (i < r)
+		f0 = montgomery_reduce(4613 * f[i]); /* f0..f3 are now in Montgomery domain */
+		f1 = montgomery_reduce(4613 * f[i + 32]);
+		f2 = montgomery_reduce(4613 * f[i + 64]);
+		f3 = montgomery_reduce(4613 * f[i + 96]);
+		g0 = g[i];
+		g1 = g[i + 32];
+		g2 = g[i + 64];
+		g3 = g[i + 96];
+
+		t = montgomery_reduce(g3 * f1 + g2 * f2 + g1 * f3);
+		t = montgomery_reduce(g0 * f0 + t * ptntt_roots[i]);
+		r[i] = CSUBQ(t);
+		t = montgomery_reduce(g3 * f2 + g2 * f3);
+		t = montgomery_reduce(g1 * f0 + g0 * f1 + t * ptntt_roots[i]);
+		r[i + 32] = CSUBQ(t);
+		t = montgomery_reduce(g3 * f3);
+		t = montgomery_reduce(g2 * f0 + g1 * f1 + g0 * f2 + t * ptntt_roots[i]);
+		r[i + 64] = CSUBQ(t);
+		t = montgomery_reduce(g3 * f0 + g2 * f1 + g1 * f2 + g0 * f3);
+		r[i + 96] = CSUBQ(t);
+	}
+	TRACE(TRACE_PT_BASEMUL | TRACE_END);
+}
+
+#elif (PTNTT_SPLIT == 8)
+void pt_ntt_basemul8(uint16_t *r, const uint16_t *f, const uint16_t *g)
+{
+	int i, t, u;
+	uint32_t fm[8], gs[8], lo, hi;
+	TRACE(TRACE_PT_BASEMUL);
+	for (i = 0; i < 16; i++)
+	{
+		for (u = 0; u < 8; u++)
 		{
-			tmp = poly[i];
-			poly[i] = poly[r];
-			poly[r] = tmp;
+			fm[u] = montgomery_reduce(4613 * f[u * 16 + i]); /* fm is now in Montgomery domain */
+			gs[u] = g[u * 16 + i];
+		}
+		for (t = 0; t < 8; t++)
+		{
+			lo = 0;
+			hi = 0;
+			for (u = 0; u <= t; u++)
+				lo += gs[t - u] * fm[u];
+			for (u = t + 1; u < 8; u++)
+				hi += gs[t + 8 - u] * fm[u];
+			lo = montgomery_reduce(lo + montgomery_reduce(hi) * ptntt_roots[i]);
+			r[t * 16 + i] = CSUBQ(lo);
 		}
 	}
+	TRACE(TRACE_PT_BASEMUL | TRACE_END);
 }
+#endif
+
+/*************************************************
+* Name:        poly_inv_pt_ntt_split
+*
+* Description: Inverse of poly_pt_ntt_split: inverse NTT of every lane of p in
+*              place, then interleaves them into r; no fold, the product is
+*              already reduced mod x^128 + 1
+*
+* Arguments:   - uint16_t *r: pointer to output polynomial with N coefficients, not p
+*              - uint16_t *p: pointer to input (NTT domain), overwritten
+**************************************************/
+void poly_inv_pt_ntt_split(uint16_t *r, uint16_t *p)
+{
+	int i, u;
+	for (u = 0; u < PTNTT_SPLIT; u++)
+		poly_invntt_pt(p + u * PTNTT_M);
+	for (i = 0; i < PTNTT_M; i++)
+		for (u = 0; u < PTNTT_SPLIT; u++)
+			r[PTNTT_SPLIT * i + u] = p[u * PTNTT_M + i];
+}
+
+#endif
+
+#elif (BRLWE_N == 256)
+
+
+/************************************************************
+* Twiddle tables of the 256-point NTT (psis_bitrev_montgomery_256,
+* psis_inv_bitrev_montgomery_256),
+* generated by ntt_tables.py (see the Makefile)
+************************************************************/
+#include "ntt_tables_256.h"
+
+#if (NTT_256_Q != NTT_Q) || (NTT_256_RLOG != 18)
+#error "ntt_tables_256.h was generated for another q or R, see NTT_TABLES_Q/NTT_TABLES_RLOG in the Makefile"
+#endif
 
 
 /*************************************************
@@ -816,105 +916,63 @@ void get_int16_half_polys(uint16_t *arr, uint8_t *poly) {
 
 
 /*************************************************
-* Name:        mul_coefficients
+* Name:        ntt
 *
-* Description: Performs pointwise (coefficient-wise) multiplication
-*              of two polynomials
-* Arguments:   - uint16_t* poly:          pointer to in/output polynomial
-*              - const uint16_t* factors: pointer to input polynomial, coefficients
-*                                         are assumed to be in Montgomery representation
+* Description: Computes negacyclic number-theoretic transform (NTT) of
+*              a polynomial in place; input in normal order, output
+*              in bitreversed order (see ntt_packed)
+*
+* Arguments:   - uint16_t * a:          pointer to in/output polynomial
+*              - const uint16_t* zetas: pointer to input twiddles with the psi twist merged;
+*                                       assumed to be in Montgomery domain
 **************************************************/
-void mul_coefficients_256(uint16_t* poly, const uint16_t* factors)
+void ntt_256(uint16_t * a, const uint16_t* zetas)
 {
-	unsigned int i;
-
-	for (i = 0; i < 256; i++)
-		poly[i] = montgomery_reduce((poly[i] * factors[i]));
+	ntt_packed(a, zetas, 8);
 }
 
 /*************************************************
-* Name:        ntt
+* Name:        invntt_256
 *
-* Description: Computes number-theoretic transform (NTT) of
-*              a polynomial in place; inputs assumed to be in
-*              bitreversed order, output in normal order
+* Description: Inverse of ntt_256 in place, scaling included; input in
+*              bitreversed order, output in normal order and reduced mod q
+*              (see invntt_packed)
 *
-* Arguments:   - uint16_t * a:          pointer to in/output polynomial
-*              - const uint16_t* omega: pointer to input powers of root of unity omega;
-*                                       assumed to be in Montgomery domain
+* Arguments:   - uint16_t * a:              pointer to in/output polynomial
+*              - const uint16_t* zetas_inv: pointer to input inverse twiddles with the psi twist merged;
+*                                           assumed to be in Montgomery domain
 **************************************************/
-void ntt_256(uint16_t * a, const uint16_t* omega)
+void invntt_256(uint16_t * a, const uint16_t* zetas_inv)
 {
-	int i, start, j, jTwiddle, distance;
-	uint16_t temp, W;
-
-
-	for (i = 0; i < 8; i += 2)
-	{
-		// Even level
-		distance = (1 << i);
-		for (start = 0; start < distance; start++)
-		{
-			jTwiddle = 0;
-			for (j = start; j < 255; j += 2 * distance)
-			{
-				W = omega[jTwiddle++];
-				temp = a[j];
-				a[j] = (temp + a[j + distance]); // Omit reduction (be lazy)
-				a[j + distance] = montgomery_reduce((W * ((uint32_t)temp + 3 * 7681 - a[j + distance])));
-			}
-		}
-
-		// Odd level
-		distance <<= 1;
-		for (start = 0; start < distance; start++)
-		{
-			jTwiddle = 0;
-			for (j = start; j < 255; j += 2 * distance)
-			{
-				W = omega[jTwiddle++];
-				temp = a[j];
-				a[j] = (temp + a[j + distance]) % 7681;
-				a[j + distance] = montgomery_reduce((W * ((uint32_t)temp + 3 * 7681 - a[j + distance])));
-			}
-		}
-	}
+	invntt_packed(a, zetas_inv, 8);
 }
 
 /*************************************************
 * Name:        poly_ntt
 *
 * Description: Computes number-theoretic transform (NTT) of
-*              a polynomial in place; inputs assumed to be in
-*              bitreversed order, output in normal order
+*              a polynomial in place; input in normal order,
+*              output in bitreversed order
 *
 * Arguments:   - uint16_t * r:          pointer to in/output polynomial
 **************************************************/
 void poly_ntt(uint16_t *r)
 {
-	mul_coefficients_256(r, psis_bitrev_montgomery);
-	ntt_256(r, omegas_bitrev_montgomery);
+	ntt_256(r, psis_bitrev_montgomery_256);
 }
 
 /*************************************************
 * Name:        poly_invntt
 *
 * Description: Inverse NTT transform of a polynomial in place
-*              Input is assumed to have coefficients in normal order
+*              Input has coefficients in bitreversed order
 *              Output has coefficients in normal order
 *
 * Arguments:   - poly *r: pointer to in/output polynomial
 **************************************************/
 void poly_invntt(uint16_t *r)
 {
-	int i;
-	bitrev_vector_256(r);
-	ntt_256((uint16_t *)r, omegas_inv_bitrev_montgomery);
-	mul_coefficients_256(r, psis_inv_montgomery);
-	for (i = 0; i < 256; i++)
-	{
-		r[i] = coeff_freeze(r[i]);
-	}
+	invntt_256(r, psis_inv_bitrev_montgomery_256);
 }
 
 /*************************************************
@@ -929,11 +987,13 @@ void poly_invntt(uint16_t *r)
 void poly_mul_pointwise(uint16_t *r, const uint16_t *a, const uint16_t *b)
 {
 	int i;
-	uint16_t t;
-	for (i = 0; i < 256; i++)
+	uint32_t x, y;
+	for (i = 0; i < 128; i++) // packed pairs
 	{
-		t = montgomery_reduce(4613 * b[i]); /* t is now in Montgomery domain, 3186->4613 */
-		r[i] = montgomery_reduce(a[i] * t);  /* r->coeffs[i] is back in normal domain */
+		x = ((const uint32_t *)a)[i];
+		y = ((const uint32_t *)b)[i];
+		y = PACK(montgomery_reduce(4613 * (y & 0xffff)), montgomery_reduce(4613 * (y >> 16))); /* y is now in Montgomery domain, 3186->4613 */
+		((uint32_t *)r)[i] = PACK(montgomery_reduce((x & 0xffff) * (y & 0xffff)), montgomery_reduce((x >> 16) * (y >> 16))); /* back in normal domain */
 		//r[i] = (a[i] * b[i]) % NTT_Q;
 	}
 }
@@ -950,8 +1010,8 @@ void poly_mul_pointwise(uint16_t *r, const uint16_t *a, const uint16_t *b)
 void poly_add2(uint16_t *r, const uint16_t *a, const uint16_t *b)
 {
 	int i;
-	for (i = 0; i < 256; i++) {
-		r[i] = (a[i] + b[i]) & (BRLWE_Q - 1);
+	for (i = 0; i < 128; i++) { // packed pairs, inputs below BRLWE_Q so no carry crosses lanes
+		((uint32_t *)r)[i] = (((const uint32_t *)a)[i] + ((const uint32_t *)b)[i]) & ((BRLWE_Q - 1) * 0x10001u);
 	}
 
 }
@@ -970,8 +1030,8 @@ void poly_sub3(uint16_t *r, const uint16_t *a, const uint16_t *b, uint16_t *c)
 {
 	int i;
 	int count = 0;
-	for (i = 0; i < 256; i++) {
-		r[i] = (c[i] + BRLWE_Q - a[i] + BRLWE_Q - b[i]) & (BRLWE_Q - 1);
+	for (i = 0; i < 128; i++) { // packed pairs, inputs below BRLWE_Q so c + 2Q - a - b never borrows across lanes
+		((uint32_t *)r)[i] = (((uint32_t *)c)[i] + 2 * BRLWE_Q * 0x10001u - ((const uint32_t *)a)[i] - ((const uint32_t *)b)[i]) & ((BRLWE_Q - 1) * 0x10001u);
 	}
 }
 
@@ -8,7 +8,6 @@
 #define PtNTT 1
 
 uint16_t montgomery_reduce(uint32_t a);
-static uint16_t coeff_freeze(uint16_t x);
 
 #if (BRLWE_N == 128)
 
@@ -39,10 +38,9 @@ struct ptpoly7 {
 	uint16_t* poly11_s;
 };
 
-void bitrev_vector_64(uint16_t* poly);
 void get_int16_polys(uint16_t *arr, uint16_t *poly);
-void mul_coefficients_64(uint16_t* poly, const uint16_t* factors);
-void ntt_64(uint16_t * a, const uint16_t* omega);
+void ntt_64(uint16_t * a, const uint16_t* zetas);
+void invntt_64(uint16_t * a, const uint16_t* zetas_inv);
 void poly_quarter_mul_pointwise(uint16_t *r, const uint16_t *a, const uint16_t *b);
 void poly_add(uint16_t *r, const uint16_t *a, const uint16_t *b);
 void poly_quarter_add(uint16_t *r, const uint16_t *a, const uint16_t *b, const uint16_t *c, const uint16_t *d);
@@ -58,11 +56,30 @@ void poly_pt_ntt7(uint16_t *p, struct ptpoly7 poly);
 void pt_ntt_bowtiemultiply(uint16_t *b, struct ptpoly4 f, struct ptpoly7 g);
 void poly_inv_ptntt(uint16_t *b);
 
+// in-place PtNTT (PTNTT_INPLACE in params.h): PTNTT_SPLIT lanes of PTNTT_M point NTTs
+#define PTNTT_M (BRLWE_N / PTNTT_SPLIT)
+
+void poly_pt_ntt_split(uint16_t *r, const uint16_t *p);
+void poly_inv_pt_ntt_split(uint16_t *r, uint16_t *p);
+		#if (PTNTT_SPLIT == 2)
+void pt_ntt_basemul2(uint16_t *r, const uint16_t *f, const uint16_t *g);
+#define pt_ntt_basemul pt_ntt_basemul2
+		#elif (PTNTT_SPLIT == 4)
+void pt_ntt_basemul4(uint16_t *r, const uint16_t *f, const uint16_t *g);
+#define pt_ntt_basemul pt_ntt_basemul4
+		#elif (PTNTT_SPLIT == 8)
+void pt_ntt_basemul8(uint16_t *r, const uint16_t *f, const uint16_t *g);
+#define pt_ntt_basemul pt_ntt_basemul8
+		#else
+#error "PTNTT_SPLIT must be 2, 4 or 8"
+		#endif
+
 	#endif
 
 #elif (BRLWE_N == 256)
 void get_int16_half_polys(uint16_t *arr, uint8_t *poly);
-void bitrev_vector_256(uint16_t* poly);
+void ntt_256(uint16_t * a, const uint16_t* zetas);
+void invntt_256(uint16_t * a, const uint16_t* zetas_inv);
 void poly_ntt(uint16_t *r);
 void poly_invntt(uint16_t *r);
 void poly_mul_pointwise(uint16_t *r, const uint16_t *a, const uint16_t *b);
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+#
+# Generates the twiddle tables of the negacyclic NTT in ntt.c for any
+# NTT-friendly (n, q, R = 2^rlog): q prime, n a power of two, 2n | q - 1.
+# Run by the Makefile (ntt_tables_<n>.h); the headers are checked in, so a
+# build without python3 works as long as the settings are unchanged.
+#
+#   ./ntt_tables.py --n 64 --q 7681 --rlog 18 [--psi p] [--suffix _64] [--attr FASTDATA] [--roots] -o ntt_tables_64.h
+#
+# The forward ntt_<n> is Cooley-Tukey (normal order in, bitreversed order
+# out) and the inverse invntt_<n> Gentleman-Sande (bitreversed in, normal
+# out), with the psi twist merged into the twiddles: no bitrev and no twist
+# pass. Butterfly block m of the level with distance len uses entry
+# k = n / (2 len) + m of the tables, psi = primitive 2n-th root of unity mod q
+# (the smallest one unless --psi is given), brv = bit reversal of log2(n)
+# bits, every value in Montgomery domain (times R mod q), every table 4-byte
+# aligned for the packed-pair kernels of ntt.c:
+#   psis_bitrev_montgomery       [n]   psi^brv(k)       forward twiddles (entry 0 unused)
+#   psis_inv_bitrev_montgomery   [n]   psi^-brv(k)      inverse twiddles, entry 0 = n^-1
+#                                                       and entry 1 times n^-1 (last level)
+#   ptntt_roots_montgomery       [n]   psi^(2brv(j)+1)  value of y in slot j (--roots)
+#
+# Before writing anything, the tables go through a model of the C code of
+# ntt.c (montgomery_reduce, the lazy reduction in ntt_<n>/invntt_<n>, the
+# 16-bit lanes of the packed pairs, uint16_t stores and uint32_t
+# intermediates): forward/inverse round trips and products against
+# schoolbook multiplication mod x^n + 1, random and worst case (all q - 1)
+# inputs. Any mismatch or overflow is an error.
+
+import argparse
+import random
+import sys
+
+class TableError(Exception):
+    pass
+
+def is_prime(q):
+    return q > 1 and all(q % d for d in range(2, int(q ** 0.5) + 1))
+
+def order(x, q):
+    k, y = 1, x
+    while y != 1:
+        y = y * x % q
+        k += 1
+    return k
+
+def bitrev(i, bits):
+    return int(format(i, "0%db" % bits)[::-1], 2) if bits else 0
+
+class Tables:
+    def __init__(self, n, q, rlog, psi=None):
+        if n < 2 or n & (n - 1):
+            raise TableError("n = %d is not a power of two" % n)
+        if not is_prime(q):
+            raise TableError("q = %d is not prime" % q)
+        if (q - 1) % (2 * n):
+            raise TableError("2n = %d does not divide q - 1 = %d, no negacyclic NTT" % (2 * n, q - 1))
+        self.n, self.q, self.rlog = n, q, rlog
+        self.R = 1 << rlog
+        if self.R <= q or (self.R - 1) * q >= 1 << 32:
+            raise TableError("R = 2^%d must be > q and R q < 2^32" % rlog)
+        self.bits = n.bit_length() - 1
+        self.qinv = -pow(q, -1, self.R) % self.R
+        self.mont_r2 = self.R * self.R % q
+        if psi is None:
+            psi = next(x for x in range(2, q) if order(x, q) == 2 * n)
+        elif order(psi % q, q) != 2 * n:
+            raise TableError("psi = %d is not a primitive %d-th root of unity mod %d" % (psi, 2 * n, q))
+        self.psi = psi % q
+
+        m = lambda e: pow(self.psi, e % (2 * n), q) * self.R % q
+        brv = [bitrev(i, self.bits) for i in range(n)]
+        self.psis = [m(brv[k]) for k in range(n)]
+        self.psis_inv = [m(-brv[k]) for k in range(n)]
+        # the last inverse level scales both outputs by n^-1
+        ninv = pow(n, -1, q)
+        self.psis_inv[0] = self.R * ninv % q
+        self.psis_inv[1] = self.psis_inv[1] * ninv % q
+        self.roots = [m(2 * brv[j] + 1) for j in range(n)]
+
+    # ---- model of ntt.c ----
+
+    def u16(self, x, what):
+        if not 0 <= x < 1 << 16:
+            raise TableError("%s = %d does not fit in uint16_t" % (what, x))
+        return x
+
+    def mont(self, a):
+        if not 0 <= a < 1 << 32:
+            raise TableError("montgomery_reduce input %d out of range" % a)
+        u = (a * self.qinv) & (self.R - 1)
+        if a + u * self.q >= 1 << 32:
+            raise TableError("montgomery_reduce(%d) overflows uint32_t" % a)
+        return (a + u * self.q) >> self.rlog
+
+    def forward(self, p):
+        # ntt_<n>: both outputs are lazy, except on every third level counted
+        # from the last one, which reduces them mod q (the output is below q)
+        n, q, a = self.n, self.q, list(p)
+        for level in range(self.bits):
+            distance = n >> (level + 1)
+            for m, start in enumerate(range(0, n, 2 * distance)):
+                w = self.psis[(1 << level) + m]
+                for j in range(start, start + distance):
+                    t = self.mont(w * a[j + distance])
+                    if t > 2 * q:
+                        raise TableError("ntt: product %d > 2q" % t)
+                    # the packed kernels compute s and d in 16-bit lanes
+                    s = self.u16(a[j] + t, "ntt lane sum")
+                    d = self.u16(a[j] + 2 * q - t, "ntt lane difference")
+                    if (self.bits - 1 - level) % 3 == 0:
+                        s, d = s % q, d % q
+                    a[j] = self.u16(s, "ntt sum")
+                    a[j + distance] = self.u16(d, "ntt difference")
+        return a
+
+    def inverse(self, p):
+        # invntt_<n>: even levels are lazy, odd levels reduce a[j] mod q; the
+        # last level multiplies both outputs by n^-1 and subtracts q if needed
+        n, q, a = self.n, self.q, list(p)
+        csubq = lambda t: t - q if t >= q else t
+        for level in range(self.bits):
+            distance = 1 << level
+            for m, start in enumerate(range(0, n, 2 * distance)):
+                w = self.psis_inv[(n >> (level + 1)) + m]
+                for j in range(start, start + distance):
+                    temp = a[j]
+                    if temp + 3 * q < a[j + distance]:
+                        raise TableError("invntt: a[j + distance] = %d >= a[j] + 3q" % a[j + distance])
+                    s = self.u16(temp + a[j + distance], "invntt lane sum")
+                    self.u16(temp + 3 * q, "invntt lane difference")
+                    d = self.mont(w * (temp + 3 * q - a[j + distance]))
+                    if level == self.bits - 1:
+                        s = self.mont(self.psis_inv[0] * s)
+                        if max(s, d) >= 2 * q:
+                            raise TableError("invntt: scaled output %d >= 2q" % max(s, d))
+                        s, d = csubq(s), csubq(d)
+                    a[j] = s % q if level & 1 else s
+                    a[j + distance] = self.u16(d, "invntt difference")
+        return a
+
+    def pointwise(self, a, b):
+        # poly_quarter_mul_pointwise: one factor into Montgomery domain with R^2 mod q
+        return [self.mont(a[i] * self.mont(self.mont_r2 * b[i])) for i in range(self.n)]
+
+    def schoolbook(self, a, b):
+        n, q = self.n, self.q
+        r = [0] * n
+        for i in range(n):
+            for j in range(n):
+                k = i + j
+                if k < n:
+                    r[k] = (r[k] + a[i] * b[j]) % q
+                else:
+                    r[k - n] = (r[k - n] - a[i] * b[j]) % q
+        return r
+
+    def selfcheck(self, trials):
+        n, q = self.n, self.q
+        rnd = random.Random(1)
+        inputs = [([q - 1] * n, [q - 1] * n), ([q - 1] * n, [1] * n), ([q] * n, [q - 1] * n)]
+        inputs += [([rnd.randrange(q) for _ in range(n)], [rnd.randrange(q) for _ in range(n)]) for _ in range(trials)]
+        inputs += [([rnd.randrange(q) for _ in range(n)], [rnd.randrange(2) for _ in range(n)]) for _ in range(trials)]
+        for a, b in inputs:
+            fa, fb = self.forward(a), self.forward(b)
+            if max(fa) >= q or max(fb) >= q:
+                raise TableError("forward output not below q")
+            if self.inverse(fa) != [x % q for x in a]:
+                raise TableError("inverse(forward(a)) != a")
+            if self.inverse(self.pointwise(fa, fb)) != self.schoolbook(a, b):
+                raise TableError("NTT product != schoolbook product mod x^%d + 1" % n)
+        y = self.forward([0, 1] + [0] * (n - 2))
+        if [v % q for v in y] != [r * pow(self.R, -1, q) % q for r in self.roots]:
+            raise TableError("slot j of the forward NTT does not evaluate at psi^(2brv(j)+1)")
+
+def c_table(ctype, name, attr, values, doc):
+    lines = ["/************************************************************",
+             "* Name:        %s" % name, "*"]
+    lines += ["* %s %s" % ("Description:" if i == 0 else "            ", d) for i, d in enumerate(doc)]
+    lines += ["************************************************************/",
+              "static const %s %s[%d] __attribute__((aligned(4)))%s = {" % (ctype, name, len(values), " " + attr if attr else "")]
+    rows = [", ".join(str(v) for v in values[i:i + 8]) for i in range(0, len(values), 8)]
+    lines += ["\t" + r + ("," if i + 1 < len(rows) else " };") for i, r in enumerate(rows)]
+    return "\n".join(lines) + "\n"
+
+def header(t, args):
+    n, sfx, attr = t.n, args.suffix, args.attr
+    guard = "NTT_TABLES_%d_H" % n
+    rdoc = "domain with R=2^%d" % t.rlog
+    opts = "--n %d --q %d --rlog %d --psi %d" % (n, t.q, t.rlog, t.psi)
+    opts += (" --suffix " + sfx if sfx else "") + (" --attr " + attr if attr else "") + (" --roots" if args.roots else "")
+    out = ["/* Generated by ntt_tables.py %s, do not edit (see the Makefile) */" % opts,
+           "", "#ifndef %s" % guard, "#define %s" % guard, "",
+           "#define NTT_%d_Q %d" % (n, t.q),
+           "#define NTT_%d_RLOG %d" % (n, t.rlog),
+           "#define NTT_%d_QINV %d // -inverse_mod(q,2^%d)" % (n, t.qinv, t.rlog),
+           "#define NTT_%d_MONT_R2 %d // R^2 mod q, into Montgomery domain with one montgomery_reduce" % (n, t.mont_r2),
+           "#define NTT_%d_PSI %d // primitive %d-th root of unity mod q" % (n, t.psi, 2 * n), ""]
+    out.append(c_table("uint16_t", "psis_bitrev_montgomery" + sfx, attr, t.psis,
+                       ["Contains powers of %dth root of -1 in Montgomery" % n, rdoc + " in bit-reversed order,",
+                        "twiddles of the forward (Cooley-Tukey) NTT"]))
+    out.append(c_table("uint16_t", "psis_inv_bitrev_montgomery" + sfx, attr, t.psis_inv,
+                       ["Contains inverses of powers of %dth root of -1" % n, "in Montgomery " + rdoc + " in bit-reversed order,",
+                        "twiddles of the inverse (Gentleman-Sande) NTT;", "entry 0 is n^-1 and entry 1 is scaled by n^-1, for the last level"]))
+    if args.roots:
+        out.append(c_table("uint16_t", "ptntt_roots_montgomery" + sfx, attr, t.roots,
+                           ["Contains the point psi^(2brv(j)+1) evaluated by slot j", "of the forward NTT (the value of y there) in Montgomery",
+                            rdoc + ", for the PtNTT base case"]))
+    out.append("#endif")
+    return "\n".join(out) + "\n"
+
+def main():
+    ap = argparse.ArgumentParser(description="negacyclic NTT twiddle tables for ntt.c")
+    ap.add_argument("--n", type=int, required=True, help="transform size")
+    ap.add_argument("--q", type=int, required=True, help="prime modulus, 2n | q - 1")
+    ap.add_argument("--rlog", type=int, required=True, help="Montgomery radix R = 2^rlog")
+    ap.add_argument("--psi", type=int, help="primitive 2n-th root of unity (default: the smallest)")
+    ap.add_argument("--suffix", default="", help="table name suffix")
+    ap.add_argument("--attr", default="", help="table attribute, e.g. FASTDATA")
+    ap.add_argument("--roots", action="store_true", help="also emit ptntt_roots_montgomery")
+    ap.add_argument("--trials", type=int, default=8, help="random products in the self-check")
+    ap.add_argument("-o", dest="out", required=True, help="output header")
+    args = ap.parse_args()
+
+    try:
+        t = Tables(args.n, args.q, args.rlog, args.psi)
+        t.selfcheck(args.trials)
+    except TableError as e:
+        print("ntt_tables.py: n=%d q=%d R=2^%d: %s" % (args.n, args.q, args.rlog, e), file=sys.stderr)
+        return 1
+    with open(args.out, "w") as f:
+        f.write(header(t, args))
+    print("ntt_tables.py: %s ok (n=%d q=%d R=2^%d psi=%d)" % (args.out, t.n, t.q, t.rlog, t.psi))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,46 @@
+/* Generated by ntt_tables.py --n 16 --q 7681 --rlog 18 --psi 97 --suffix _16 --attr FASTDATA --roots, do not edit (see the Makefile) */
+
+#ifndef NTT_TABLES_16_H
+#define NTT_TABLES_16_H
+
+#define NTT_16_Q 7681
+#define NTT_16_RLOG 18
+#define NTT_16_QINV 7679 // -inverse_mod(q,2^18)
+#define NTT_16_MONT_R2 4613 // R^2 mod q, into Montgomery domain with one montgomery_reduce
+#define NTT_16_PSI 97 // primitive 32-th root of unity mod q
+
+/************************************************************
+* Name:        psis_bitrev_montgomery_16
+*
+* Description: Contains powers of 16th root of -1 in Montgomery
+*              domain with R=2^18 in bit-reversed order,
+*              twiddles of the forward (Cooley-Tukey) NTT
+************************************************************/
+static const uint16_t psis_bitrev_montgomery_16[16] __attribute__((aligned(4))) FASTDATA = {
+	990, 254, 6819, 2634, 5538, 1095, 578, 4400,
+	3858, 1595, 877, 2025, 7197, 6362, 2299, 4345 };
+
+/************************************************************
+* Name:        psis_inv_bitrev_montgomery_16
+*
+* Description: Contains inverses of powers of 16th root of -1
+*              in Montgomery domain with R=2^18 in bit-reversed order,
+*              twiddles of the inverse (Gentleman-Sande) NTT;
+*              entry 0 is n^-1 and entry 1 is scaled by n^-1, for the last level
+************************************************************/
+static const uint16_t psis_inv_bitrev_montgomery_16[16] __attribute__((aligned(4))) FASTDATA = {
+	1022, 6705, 5047, 862, 3281, 7103, 6586, 2143,
+	3336, 5382, 1319, 484, 5656, 6804, 6086, 3823 };
+
+/************************************************************
+* Name:        ptntt_roots_montgomery_16
+*
+* Description: Contains the point psi^(2brv(j)+1) evaluated by slot j
+*              of the forward NTT (the value of y there) in Montgomery
+*              domain with R=2^18, for the PtNTT base case
+************************************************************/
+static const uint16_t ptntt_roots_montgomery_16[16] __attribute__((aligned(4))) FASTDATA = {
+	3858, 3823, 1595, 6086, 877, 6804, 2025, 5656,
+	7197, 484, 6362, 1319, 2299, 5382, 4345, 3336 };
+
+#endif
@@ -0,0 +1,95 @@
+/* Generated by ntt_tables.py --n 256 --q 7681 --rlog 18 --psi 62 --suffix _256, do not edit (see the Makefile) */
+
+#ifndef NTT_TABLES_256_H
+#define NTT_TABLES_256_H
+
+#define NTT_256_Q 7681
+#define NTT_256_RLOG 18
+#define NTT_256_QINV 7679 // -inverse_mod(q,2^18)
+#define NTT_256_MONT_R2 4613 // R^2 mod q, into Montgomery domain with one montgomery_reduce
+#define NTT_256_PSI 62 // primitive 512-th root of unity mod q
+
+/************************************************************
+* Name:        psis_bitrev_montgomery_256
+*
+* Description: Contains powers of 256th root of -1 in Montgomery
+*              domain with R=2^18 in bit-reversed order,
+*              twiddles of the forward (Cooley-Tukey) NTT
+************************************************************/
+static const uint16_t psis_bitrev_montgomery_256[256] __attribute__((aligned(4))) = {
+	990, 7427, 2634, 6819, 578, 3281, 2143, 1095,
+	484, 6362, 3336, 5382, 6086, 3823, 877, 5656,
+	3583, 7010, 6414, 263, 1285, 291, 7143, 7338,
+	1581, 5134, 5184, 5932, 4042, 5775, 2468, 3,
+	606, 729, 5383, 962, 3240, 7548, 5129, 7653,
+	5929, 4965, 2461, 641, 1584, 2666, 1142, 157,
+	7407, 5222, 5602, 5142, 6140, 5485, 4931, 1559,
+	2085, 5284, 2056, 3538, 7269, 3535, 7190, 1957,
+	3465, 6792, 1538, 4664, 2023, 7643, 3660, 7673,
+	1694, 6905, 3995, 3475, 5939, 1859, 6910, 4434,
+	1019, 1492, 7087, 4761, 657, 4859, 5798, 2640,
+	1693, 2607, 2782, 5400, 6466, 1010, 957, 3851,
+	2121, 6392, 7319, 3367, 3659, 3375, 6430, 7583,
+	1549, 5856, 4773, 6084, 5544, 1650, 3997, 4390,
+	6722, 2915, 4245, 2635, 6128, 7676, 5737, 1616,
+	3457, 3132, 7196, 4702, 6239, 851, 2122, 3009,
+	7613, 7295, 2007, 323, 5112, 3716, 2289, 6442,
+	6965, 2713, 7126, 3401, 963, 6596, 607, 5027,
+	7078, 4484, 5937, 944, 2860, 2680, 5049, 1777,
+	5850, 3387, 6487, 6777, 4812, 4724, 7077, 186,
+	6848, 6793, 3463, 5877, 1174, 7116, 3077, 5945,
+	6591, 590, 6643, 1337, 6036, 3991, 1675, 2053,
+	6055, 1162, 1679, 3883, 4311, 2106, 6163, 4486,
+	6374, 5006, 4576, 4288, 5180, 4102, 282, 6119,
+	7443, 6330, 3184, 4971, 2530, 5325, 4171, 7185,
+	5175, 5655, 1898, 382, 7211, 43, 5965, 6073,
+	1730, 332, 1577, 3304, 2329, 1699, 6150, 2379,
+	5113, 333, 3502, 4517, 1480, 1172, 5567, 651,
+	925, 4573, 599, 1367, 4109, 1863, 6929, 1605,
+	3866, 2065, 4048, 839, 5764, 2447, 2022, 3345,
+	1990, 4067, 2036, 2069, 3567, 7371, 2368, 339,
+	6947, 2159, 654, 7327, 2768, 6676, 987, 2214 };
+
+/************************************************************
+* Name:        psis_inv_bitrev_montgomery_256
+*
+* Description: Contains inverses of powers of 256th root of -1
+*              in Montgomery domain with R=2^18 in bit-reversed order,
+*              twiddles of the inverse (Gentleman-Sande) NTT;
+*              entry 0 is n^-1 and entry 1 is scaled by n^-1, for the last level
+************************************************************/
+static const uint16_t psis_inv_bitrev_montgomery_256[256] __attribute__((aligned(4))) = {
+	1024, 61, 862, 5047, 6586, 5538, 4400, 7103,
+	2025, 6804, 3858, 1595, 2299, 4345, 1319, 7197,
+	7678, 5213, 1906, 3639, 1749, 2497, 2547, 6100,
+	343, 538, 7390, 6396, 7418, 1267, 671, 4098,
+	5724, 491, 4146, 412, 4143, 5625, 2397, 5596,
+	6122, 2750, 2196, 1541, 2539, 2079, 2459, 274,
+	7524, 6539, 5015, 6097, 7040, 5220, 2716, 1752,
+	28, 2552, 133, 4441, 6719, 2298, 6952, 7075,
+	4672, 5559, 6830, 1442, 2979, 485, 4549, 4224,
+	6065, 1944, 5, 1553, 5046, 3436, 4766, 959,
+	3291, 3684, 6031, 2137, 1597, 2908, 1825, 6132,
+	98, 1251, 4306, 4022, 4314, 362, 1289, 5560,
+	3830, 6724, 6671, 1215, 2281, 4899, 5074, 5988,
+	5041, 1883, 2822, 7024, 2920, 594, 6189, 6662,
+	3247, 771, 5822, 1742, 4206, 3686, 776, 5987,
+	8, 4021, 38, 5658, 3017, 6143, 889, 4216,
+	5467, 6694, 1005, 4913, 354, 7027, 5522, 734,
+	7342, 5313, 310, 4114, 5612, 5645, 3614, 5691,
+	4336, 5659, 5234, 1917, 6842, 3633, 5616, 3815,
+	6076, 752, 5818, 3572, 6314, 7082, 3108, 6756,
+	7030, 2114, 6509, 6201, 3164, 4179, 7348, 2568,
+	5302, 1531, 5982, 5352, 4377, 6104, 7349, 5951,
+	1608, 1716, 7638, 470, 7299, 5783, 2026, 2506,
+	496, 3510, 2356, 5151, 2710, 4497, 1351, 238,
+	1562, 7399, 3579, 2501, 3393, 3105, 2675, 1307,
+	3195, 1518, 5575, 3370, 3798, 6002, 6519, 1626,
+	5628, 6006, 3690, 1645, 6344, 1038, 7091, 1090,
+	1736, 4604, 565, 6507, 1804, 4218, 888, 833,
+	7495, 604, 2957, 2869, 904, 1194, 4294, 1831,
+	5904, 2632, 5001, 4821, 6737, 1744, 3197, 603,
+	2654, 7074, 1085, 6718, 4280, 555, 4968, 716,
+	1239, 5392, 3965, 2569, 7358, 5674, 386, 68 };
+
+#endif
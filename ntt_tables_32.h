@@ -0,0 +1,52 @@
+/* Generated by ntt_tables.py --n 32 --q 7681 --rlog 18 --psi 330 --suffix _32 --attr FASTDATA --roots, do not edit (see the Makefile) */
+
+#ifndef NTT_TABLES_32_H
+#define NTT_TABLES_32_H
+
+#define NTT_32_Q 7681
+#define NTT_32_RLOG 18
+#define NTT_32_QINV 7679 // -inverse_mod(q,2^18)
+#define NTT_32_MONT_R2 4613 // R^2 mod q, into Montgomery domain with one montgomery_reduce
+#define NTT_32_PSI 330 // primitive 64-th root of unity mod q
+
+/************************************************************
+* Name:        psis_bitrev_montgomery_32
+*
+* Description: Contains powers of 32th root of -1 in Montgomery
+*              domain with R=2^18 in bit-reversed order,
+*              twiddles of the forward (Cooley-Tukey) NTT
+************************************************************/
+static const uint16_t psis_bitrev_montgomery_32[32] __attribute__((aligned(4))) FASTDATA = {
+	990, 7427, 2634, 6819, 578, 3281, 2143, 1095,
+	484, 6362, 3336, 5382, 6086, 3823, 877, 5656,
+	4098, 671, 1267, 7418, 6396, 7390, 538, 343,
+	6100, 2547, 2497, 1749, 3639, 1906, 5213, 7678 };
+
+/************************************************************
+* Name:        psis_inv_bitrev_montgomery_32
+*
+* Description: Contains inverses of powers of 32th root of -1
+*              in Montgomery domain with R=2^18 in bit-reversed order,
+*              twiddles of the inverse (Gentleman-Sande) NTT;
+*              entry 0 is n^-1 and entry 1 is scaled by n^-1, for the last level
+************************************************************/
+static const uint16_t psis_inv_bitrev_montgomery_32[32] __attribute__((aligned(4))) FASTDATA = {
+	511, 488, 862, 5047, 6586, 5538, 4400, 7103,
+	2025, 6804, 3858, 1595, 2299, 4345, 1319, 7197,
+	3, 2468, 5775, 4042, 5932, 5184, 5134, 1581,
+	7338, 7143, 291, 1285, 263, 6414, 7010, 3583 };
+
+/************************************************************
+* Name:        ptntt_roots_montgomery_32
+*
+* Description: Contains the point psi^(2brv(j)+1) evaluated by slot j
+*              of the forward NTT (the value of y there) in Montgomery
+*              domain with R=2^18, for the PtNTT base case
+************************************************************/
+static const uint16_t ptntt_roots_montgomery_32[32] __attribute__((aligned(4))) FASTDATA = {
+	4098, 3583, 671, 7010, 1267, 6414, 7418, 263,
+	6396, 1285, 7390, 291, 538, 7143, 343, 7338,
+	6100, 1581, 2547, 5134, 2497, 5184, 1749, 5932,
+	3639, 4042, 1906, 5775, 5213, 2468, 7678, 3 };
+
+#endif
@@ -0,0 +1,64 @@
+/* Generated by ntt_tables.py --n 64 --q 7681 --rlog 18 --psi 202 --suffix _64 --attr FASTDATA --roots, do not edit (see the Makefile) */
+
+#ifndef NTT_TABLES_64_H
+#define NTT_TABLES_64_H
+
+#define NTT_64_Q 7681
+#define NTT_64_RLOG 18
+#define NTT_64_QINV 7679 // -inverse_mod(q,2^18)
+#define NTT_64_MONT_R2 4613 // R^2 mod q, into Montgomery domain with one montgomery_reduce
+#define NTT_64_PSI 202 // primitive 128-th root of unity mod q
+
+/************************************************************
+* Name:        psis_bitrev_montgomery_64
+*
+* Description: Contains powers of 64th root of -1 in Montgomery
+*              domain with R=2^18 in bit-reversed order,
+*              twiddles of the forward (Cooley-Tukey) NTT
+************************************************************/
+static const uint16_t psis_bitrev_montgomery_64[64] __attribute__((aligned(4))) FASTDATA = {
+	990, 254, 6819, 2634, 2143, 6586, 7103, 3281,
+	6086, 3858, 5656, 877, 6362, 484, 4345, 5382,
+	1581, 2547, 5932, 5184, 2468, 7678, 3639, 5775,
+	6414, 7418, 4098, 7010, 291, 1285, 538, 7338,
+	274, 5222, 2539, 2079, 2750, 1559, 6140, 2196,
+	412, 3535, 5724, 491, 2397, 5596, 2056, 4143,
+	4441, 7548, 28, 2552, 6952, 7075, 5383, 6719,
+	5220, 641, 5929, 2716, 5015, 6097, 1142, 7524 };
+
+/************************************************************
+* Name:        psis_inv_bitrev_montgomery_64
+*
+* Description: Contains inverses of powers of 64th root of -1
+*              in Montgomery domain with R=2^18 in bit-reversed order,
+*              twiddles of the inverse (Gentleman-Sande) NTT;
+*              entry 0 is n^-1 and entry 1 is scaled by n^-1, for the last level
+************************************************************/
+static const uint16_t psis_inv_bitrev_montgomery_64[64] __attribute__((aligned(4))) FASTDATA = {
+	4096, 7437, 5047, 862, 4400, 578, 1095, 5538,
+	2299, 3336, 7197, 1319, 6804, 2025, 3823, 1595,
+	343, 7143, 6396, 7390, 671, 3583, 263, 1267,
+	1906, 4042, 3, 5213, 2497, 1749, 5134, 6100,
+	157, 6539, 1584, 2666, 4965, 1752, 7040, 2461,
+	962, 2298, 606, 729, 5129, 7653, 133, 3240,
+	3538, 5625, 2085, 5284, 7190, 1957, 4146, 7269,
+	5485, 1541, 6122, 4931, 5602, 5142, 2459, 7407 };
+
+/************************************************************
+* Name:        ptntt_roots_montgomery_64
+*
+* Description: Contains the point psi^(2brv(j)+1) evaluated by slot j
+*              of the forward NTT (the value of y there) in Montgomery
+*              domain with R=2^18, for the PtNTT base case
+************************************************************/
+static const uint16_t ptntt_roots_montgomery_64[64] __attribute__((aligned(4))) FASTDATA = {
+	274, 7407, 5222, 2459, 2539, 5142, 2079, 5602,
+	2750, 4931, 1559, 6122, 6140, 1541, 2196, 5485,
+	412, 7269, 3535, 4146, 5724, 1957, 491, 7190,
+	2397, 5284, 5596, 2085, 2056, 5625, 4143, 3538,
+	4441, 3240, 7548, 133, 28, 7653, 2552, 5129,
+	6952, 729, 7075, 606, 5383, 2298, 6719, 962,
+	5220, 2461, 641, 7040, 5929, 1752, 2716, 4965,
+	5015, 2666, 6097, 1584, 1142, 6539, 7524, 157 };
+
+#endif
@@ -8,24 +8,111 @@
 
 //#define hw_mul 1
 
-#define NTT_Q 7681 
+#ifndef RAMFUNC_EN
+#define RAMFUNC_EN 1 // run the NTT hot path (kernels + twiddle tables) from SRAM instead of XIP flash
+#endif
+#ifndef PTNTT_INPLACE
+#define PTNTT_INPLACE 1 // PtNTT Ring_mul: 1 = PTNTT_SPLIT-way split straight from the N coefficient inputs into ans (N coefficients of heap), 0 = 4-way split of zero padded 2N copies
+#endif
+#ifndef PTNTT_SPLIT
+#define PTNTT_SPLIT 2 // PTNTT_INPLACE split factor k = 2, 4 or 8: k lanes of N/k point NTTs (x^N + 1 = y^(N/k) + 1, y = x^k), k*k products per slot in the base case
+#endif
+#ifndef FLASHCAL_EN
+#define FLASHCAL_EN 1 // pick the fastest working flash read mode at boot, see flash_calibrate() in firmware.c
+#endif
+#ifndef UART_IRQ_EN
+#define UART_IRQ_EN 0 // putchar() fills a RAM ring buffer drained by the UART TX IRQ, so output overlaps with computation
+#endif
+#ifndef UART_TX_BUF
+#define UART_TX_BUF 256 // UART_IRQ_EN ring buffer bytes, power of two
+#endif
+#ifndef TRACE_EN
+#define TRACE_EN 0 // record BRLWE function entry/exit cycles in a RAM ring buffer (trace.h), printed by trace_dump()
+#endif
+#ifndef TRACE_DEPTH
+#define TRACE_DEPTH 16 // trace ring buffer entries (16 bytes each), power of two
+#endif
+#ifndef MEM_STATS_EN
+#define MEM_STATS_EN 0 // heap statistics in alloc.c (peak/current bytes, fragmentation, list walks, call sites), printed by mem_stats_dump()
+#endif
+#ifndef STACK_PAINT_EN
+#define STACK_PAINT_EN 0 // fill the free stack with a canary before each operation and print its depth afterwards (stack.h)
+#endif
+#ifndef RNG_SEEDED
+#define RNG_SEEDED 0 // 1: sample from the software PRNG in prng.h seeded with RNG_SEED instead of the hardware LFSR (reproducible runs, KAT)
+#endif
+#ifndef RNG_SEED
+#define RNG_SEED 0x2545f491
+#endif
+#ifndef BENCH_ITERS
+#define BENCH_ITERS 0 // > 0: replace the demo in main() by BENCH_ITERS timed runs per operation, CSV summary over UART
+#endif
+#ifndef BENCH_BATCH_K
+#define BENCH_BATCH_K 4 // messages per BRLWE_Encry_batch() call in the benchmark
+#endif
+#ifndef BENCH_STREAM_BYTES
+#define BENCH_STREAM_BYTES 64 // bytes per BRLWE_Stream_* run in the benchmark (<= BRLWE_N, taken from the test vector a)
+#endif
+#ifndef CPU_HZ
+#define CPU_HZ 12000000 // core clock (12 MHz on hx8kdemo and icebreaker), for the messages per second figures
+#endif
+#ifndef BRLWE_DPK
+#define BRLWE_DPK 0 // 1..BRLWE_QBITS-1: BRLWE_Key_Gen outputs pk compressed to this many bits per coefficient, the BRLWE_Encry* functions expect it; 0: off
+#endif
+#ifndef BRLWE_DC1
+#define BRLWE_DC1 0 // 1..BRLWE_QBITS-1: BRLWE_Encry outputs c1 compressed to this many bits per coefficient, BRLWE_Decry expects it; 0: off
+#endif
+#ifndef BRLWE_DC2
+#define BRLWE_DC2 0 // same for c2
+#endif
+#ifndef COMPRESS_TRIALS
+#define COMPRESS_TRIALS 0 // > 0: replace the demo in main() by a decryption failure sweep over the compression bits d (compress_sweep())
+#endif
+#ifndef SERVICE_EN
+#define SERVICE_EN 0 // 1: replace the demo in main() by the binary UART service loop (service_run(), brlwe_client.py), no ENTER prompt, no RNG self test
+#endif
+#ifndef SIM_BOOT
+#define SIM_BOOT 0 // simulation run: no ENTER prompt, no RNG self test, LEDs = 0xa5 when done (hx8kdemo_tb.v)
+#endif
+
+#define NTT_Q 7681
+
+// RAMFUNC : code copied from flash into SRAM by start.s (.ramfunc section)
+// FASTDATA: read-only tables copied into SRAM by start.s (.fastdata section); use on const objects only
+#if defined(RAMFUNC_EN) && (RAMFUNC_EN == 1)
+	#define RAMFUNC  __attribute__((section(".ramfunc"), noinline))
+	#define FASTDATA __attribute__((section(".fastdata")))
+#else
+	#define RAMFUNC
+	#define FASTDATA
+#endif
 
 #if defined(RBINLWEENC1) && (RBINLWEENC1 == 1)
 	#define BRLWE_N 256 // n = 256 : polynomials length
 	#define BRLWE_Q 128 // q = 128 : log2(q) = coeffidences data length; causing 1 bit of each byte wasted when q = 128
+	#define BRLWE_QBITS 7 // bits per coefficient, ceil(log2(q))
+	#define BRLWE_SET 1 // parameter set id in the wire format header (brlwe.h)
 #elif defined(RBINLWEENC2) && (RBINLWEENC2 == 1)
 	#define BRLWE_N 256
 	#define BRLWE_Q 256
+	#define BRLWE_QBITS 8
+	#define BRLWE_SET 2
 #elif defined(RBINLWEENCT) && (RBINLWEENCT == 1)
 	#define BRLWE_N 4
 	#define BRLWE_Q 256
+	#define BRLWE_QBITS 8
+	#define BRLWE_SET 5
 #elif defined(RBINLWEENC3) && (RBINLWEENC3 == 1)
 	#define BRLWE_N 512
 	#define BRLWE_Q 256
+	#define BRLWE_QBITS 8
+	#define BRLWE_SET 3
 #else
 
 	#define BRLWE_N 128
 	#define BRLWE_Q 7681
+	#define BRLWE_QBITS 13
+	#define BRLWE_SET 4
 
 #endif
 
@@ -1,8 +1,75 @@
 #!/usr/bin/env python3
 
+import sys
 import matplotlib.pyplot as plt
 import numpy as np
 
+# ---- Benchmark mode (firmware built with -DBENCH_ITERS=n) ----
+#
+# ./performance.py uart.log [more.log ..] plots the "bench," CSV lines the
+# firmware prints into bench.png (median cycles, min/max as error bars) and
+# prints the table with CPI. Without arguments the flash mode plot below is made.
+
+def parse_bench(lines):
+    results = list()
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("bench,") or line.startswith("bench,params"):
+            continue
+        f = line.split(",")
+        results.append({
+            "params": f[1], "backend": f[2], "op": f[3], "iters": int(f[4]),
+            "cycles": [int(x) for x in f[5:9]],    # min, median, mean, max
+            "instret": [int(x) for x in f[9:13]],
+        })
+    return results
+
+def plot_bench(files):
+    results = list()
+    for name in files:
+        with open(name, errors="replace") as f:
+            results += parse_bench(f)
+    if not results:
+        sys.exit("no bench lines found")
+
+    configs = list()
+    ops = list()
+    for r in results:
+        if (r["params"], r["backend"]) not in configs:
+            configs.append((r["params"], r["backend"]))
+        if r["op"] not in ops:
+            ops.append(r["op"])
+
+    print("%-12s %-12s %-10s %10s %10s %10s %10s %6s" % ("params", "backend", "op",
+            "min", "median", "mean", "max", "CPI"))
+    for r in results:
+        print("%-12s %-12s %-10s %10d %10d %10d %10d %6.2f" % (r["params"], r["backend"], r["op"],
+                r["cycles"][0], r["cycles"][1], r["cycles"][2], r["cycles"][3],
+                r["cycles"][1] / r["instret"][1]))
+
+    width = 0.8 / len(configs)
+    plt.figure(figsize=(10, 5))
+    plt.title("BRLWE cycles per operation (median, min/max)")
+    for k, config in enumerate(configs):
+        med, lo, hi = list(), list(), list()
+        for op in ops:
+            r = [r for r in results if (r["params"], r["backend"]) == config and r["op"] == op]
+            c = r[0]["cycles"] if r else [0, 0, 0, 0]
+            med.append(c[1])
+            lo.append(c[1] - c[0])
+            hi.append(c[3] - c[1])
+        x = np.arange(len(ops)) + (k - (len(configs) - 1) / 2) * width
+        plt.bar(x, med, width, yerr=[lo, hi], capsize=3, label="%s %s" % config)
+    plt.xticks(range(len(ops)), ops)
+    plt.ylabel("cycles")
+    plt.legend()
+    plt.grid(axis="y")
+    plt.savefig("bench.png")
+
+if len(sys.argv) > 1:
+    plot_bench(sys.argv[1:])
+    sys.exit(0)
+
 uncompr_text = """
 default        : 010f52ef
 dspi-8         : 008dc82f
@@ -71,6 +71,7 @@ module picosoc (
 );
 	parameter [0:0] BARREL_SHIFTER = 1;
 	parameter [0:0] ENABLE_MULDIV = 1;
+	parameter [0:0] ENABLE_FAST_MUL = 0;             // with ENABLE_MULDIV: parallel multiplier (picorv32_pcpi_fast_mul, a few cycles) instead of the sequential one
 	parameter [0:0] ENABLE_COMPRESSED = 1;
 	parameter [0:0] ENABLE_COUNTERS = 1;
 	parameter [0:0] ENABLE_IRQ_QREGS = 0;
@@ -79,10 +80,16 @@ module picosoc (
 	parameter [31:0] STACKADDR = (4*MEM_WORDS);       // end of memory
 	parameter [31:0] PROGADDR_RESET = 32'h 0010_0000; // 1 MB into flash
 	parameter [31:0] PROGADDR_IRQ = 32'h 0000_0000;
+	parameter integer CACHE_BYTES = 0;                // flash read cache, 0 = none (see spimemio_cache)
+	parameter [0:0] ENABLE_PERF = 1;                  // bus performance counters (see picosoc_perf)
+	parameter [31:0] PERF_RNG_ADDR = 32'h 0300_1000;  // iomem addresses counted as RNG / user RAM
+	parameter [31:0] PERF_URAM_ADDR = 32'h 0300_2000;
+	parameter integer PERF_URAM_BYTES = 4*256;
+	parameter integer UART_TX_FIFO = 16;              // simpleuart transmit FIFO bytes (0 or a power of two >= 2)
 
 	reg [31:0] irq;
 	wire irq_stall = 0;
-	wire irq_uart = 0;
+	wire irq_uart;
 
 	always @* begin
 		irq = 0;
@@ -104,6 +111,11 @@ module picosoc (
 	wire spimem_ready;
 	wire [31:0] spimem_rdata;
 
+	wire        spimemio_valid;
+	wire        spimemio_ready;
+	wire [23:0] spimemio_addr;
+	wire [31:0] spimemio_rdata;
+
 	reg ram_ready;
 	wire [31:0] ram_rdata;
 
@@ -122,12 +134,46 @@ module picosoc (
 	wire [31:0] simpleuart_reg_dat_do;
 	wire        simpleuart_reg_dat_wait;
 
+	wire        simpleuart_reg_stat_sel = mem_valid && (mem_addr == 32'h 0200_0014);
+	wire [31:0] simpleuart_reg_stat_do;
+
+	wire        cache_hits_sel = mem_valid && (mem_addr == 32'h 0200_000C);
+	wire [31:0] cache_hits_do;
+
+	wire        cache_misses_sel = mem_valid && (mem_addr == 32'h 0200_0010);
+	wire [31:0] cache_misses_do;
+
+	wire        perf_sel = ENABLE_PERF && mem_valid && (mem_addr[31:8] == 24'h 02_0001);
+	wire [31:0] perf_do;
+
 	assign mem_ready = (iomem_valid && iomem_ready) || spimem_ready || ram_ready || spimemio_cfgreg_sel ||
-			simpleuart_reg_div_sel || (simpleuart_reg_dat_sel && !simpleuart_reg_dat_wait);
+			simpleuart_reg_div_sel || (simpleuart_reg_dat_sel && !simpleuart_reg_dat_wait) || simpleuart_reg_stat_sel ||
+			cache_hits_sel || cache_misses_sel || perf_sel;
 
 	assign mem_rdata = (iomem_valid && iomem_ready) ? iomem_rdata : spimem_ready ? spimem_rdata : ram_ready ? ram_rdata :
 			spimemio_cfgreg_sel ? spimemio_cfgreg_do : simpleuart_reg_div_sel ? simpleuart_reg_div_do :
-			simpleuart_reg_dat_sel ? simpleuart_reg_dat_do : 32'h 0000_0000;
+			simpleuart_reg_dat_sel ? simpleuart_reg_dat_do : cache_hits_sel ? cache_hits_do :
+			cache_misses_sel ? cache_misses_do : perf_sel ? perf_do : simpleuart_reg_stat_sel ? simpleuart_reg_stat_do :
+			32'h 0000_0000;
+
+	// bus target of the current transfer, as counted by picosoc_perf
+	reg [2:0] perf_target;
+
+	always @* begin
+		perf_target = 7;
+		if (mem_addr < 4*MEM_WORDS)
+			perf_target = 1;                                  // SRAM
+		else if (mem_addr < 32'h 0200_0000)
+			perf_target = 0;                                  // flash
+		else if (simpleuart_reg_div_sel || simpleuart_reg_dat_sel || simpleuart_reg_stat_sel)
+			perf_target = 2;                                  // UART
+		else if (mem_addr == PERF_RNG_ADDR)
+			perf_target = 3;                                  // RNG
+		else if (mem_addr >= PERF_URAM_ADDR && mem_addr - PERF_URAM_ADDR < PERF_URAM_BYTES)
+			perf_target = 4;                                  // user RAM
+		else if (iomem_valid)
+			perf_target = 5;                                  // other iomem (GPIO, ..)
+	end
 
 	picorv32 #(
 		.STACKADDR(STACKADDR),
@@ -137,6 +183,7 @@ module picosoc (
 		.COMPRESSED_ISA(ENABLE_COMPRESSED),
 		.ENABLE_COUNTERS(ENABLE_COUNTERS),
 		.ENABLE_MUL(ENABLE_MULDIV),
+		.ENABLE_FAST_MUL(ENABLE_MULDIV && ENABLE_FAST_MUL),
 		.ENABLE_DIV(ENABLE_MULDIV),
 		.ENABLE_IRQ(1),
 		.ENABLE_IRQ_QREGS(ENABLE_IRQ_QREGS)
@@ -153,14 +200,36 @@ module picosoc (
 		.irq         (irq        )
 	);
 
-	spimemio spimemio (
+	spimemio_cache #(
+		.CACHE_BYTES(CACHE_BYTES)
+	) spimemio_cache (
 		.clk    (clk),
 		.resetn (resetn),
+		.flush  (spimemio_cfgreg_sel && |mem_wstrb),
+
 		.valid  (mem_valid && mem_addr >= 4*MEM_WORDS && mem_addr < 32'h 0200_0000),
 		.ready  (spimem_ready),
 		.addr   (mem_addr[23:0]),
 		.rdata  (spimem_rdata),
 
+		.mem_valid (spimemio_valid),
+		.mem_ready (spimemio_ready),
+		.mem_addr  (spimemio_addr),
+		.mem_rdata (spimemio_rdata),
+
+		.counters_reset (cache_hits_sel && |mem_wstrb),
+		.hit_count      (cache_hits_do),
+		.miss_count     (cache_misses_do)
+	);
+
+	spimemio spimemio (
+		.clk    (clk),
+		.resetn (resetn),
+		.valid  (spimemio_valid),
+		.ready  (spimemio_ready),
+		.addr   (spimemio_addr),
+		.rdata  (spimemio_rdata),
+
 		.flash_csb    (flash_csb   ),
 		.flash_clk    (flash_clk   ),
 
@@ -184,7 +253,9 @@ module picosoc (
 		.cfgreg_do(spimemio_cfgreg_do)
 	);
 
-	simpleuart simpleuart (
+	simpleuart #(
+		.TX_FIFO_DEPTH(UART_TX_FIFO)
+	) simpleuart (
 		.clk         (clk         ),
 		.resetn      (resetn      ),
 
@@ -199,9 +270,31 @@ module picosoc (
 		.reg_dat_re  (simpleuart_reg_dat_sel && !mem_wstrb),
 		.reg_dat_di  (mem_wdata),
 		.reg_dat_do  (simpleuart_reg_dat_do),
-		.reg_dat_wait(simpleuart_reg_dat_wait)
+		.reg_dat_wait(simpleuart_reg_dat_wait),
+
+		.reg_stat_we (simpleuart_reg_stat_sel ? mem_wstrb[0] : 1'b 0),
+		.reg_stat_di (mem_wdata),
+		.reg_stat_do (simpleuart_reg_stat_do),
+
+		.irq         (irq_uart    )
 	);
 
+	generate if (ENABLE_PERF) begin: perf
+		picosoc_perf perf (
+			.clk       (clk        ),
+			.resetn    (resetn     ),
+			.mem_valid (mem_valid  ),
+			.mem_ready (mem_ready  ),
+			.target    (perf_target),
+			.reg_we    (perf_sel ? mem_wstrb : 4'b 0000),
+			.reg_addr  (mem_addr[7:0]),
+			.reg_di    (mem_wdata  ),
+			.reg_do    (perf_do    )
+		);
+	end else begin: no_perf
+		assign perf_do = 0;
+	end endgenerate
+
 	always @(posedge clk)
 		ram_ready <= mem_valid && !mem_ready && mem_addr < 4*MEM_WORDS;
 
@@ -216,6 +309,61 @@ module picosoc (
 	);
 endmodule
 
+// Bus performance counters, mapped at 0x0200_0100:
+//
+//   0x00       control: bit 0 = count enable (reset = 1), writing bit 1 clears all counters
+//   0x10+8*i   completed transfers to target i
+//   0x14+8*i   wait cycles (valid && !ready) on target i
+//
+// Targets: 0 = flash, 1 = SRAM, 2 = UART, 3 = RNG, 4 = user RAM, 5 = other iomem.
+// Clear enable to take a consistent snapshot, the counter reads are not counted.
+
+module picosoc_perf (
+	input clk, resetn,
+
+	input       mem_valid,
+	input       mem_ready,
+	input [2:0] target,
+
+	input   [3:0] reg_we,
+	input   [7:0] reg_addr,
+	input  [31:0] reg_di,
+	output [31:0] reg_do
+);
+	localparam integer TARGETS = 6;
+
+	reg enable;
+	reg [31:0] xfers [0:TARGETS-1];
+	reg [31:0] waits [0:TARGETS-1];
+
+	wire [2:0] reg_index = reg_addr[5:3] - 2;
+	wire reg_counter = reg_addr >= 8'h 10 && reg_addr < 8'h 10 + 8*TARGETS;
+
+	assign reg_do = reg_addr == 0 ? {31'b 0, enable} : !reg_counter ? 0 :
+			reg_addr[2] ? waits[reg_index] : xfers[reg_index];
+
+	integer i;
+
+	always @(posedge clk) begin
+		if (!resetn || (reg_we[0] && reg_addr == 0 && reg_di[1])) begin
+			for (i = 0; i < TARGETS; i = i+1) begin
+				xfers[i] <= 0;
+				waits[i] <= 0;
+			end
+		end else if (enable && mem_valid && target < TARGETS) begin
+			if (mem_ready)
+				xfers[target] <= xfers[target] + 1;
+			else
+				waits[target] <= waits[target] + 1;
+		end
+
+		if (!resetn)
+			enable <= 1;
+		else if (reg_we[0] && reg_addr == 0)
+			enable <= reg_di[0];
+	end
+endmodule
+
 // Implementation note:
 // Replace the following two modules with wrappers for your SRAM cells.
 
@@ -0,0 +1,36 @@
+#ifndef _PRNG_H_
+#define _PRNG_H_
+
+#include <stdint.h>
+
+// Software xorshift32 generator for RNG_SEEDED builds (params.h). It is NOT
+// a secure RNG: it only makes runs reproducible, so the firmware and the host
+// KAT generator (kat/kat.c) sample the same secrets and errors from RNG_SEED.
+
+static uint32_t prng_state = 1;
+
+static void prng_seed(uint32_t seed)
+{
+	prng_state = seed ? seed : 1; // xorshift gets stuck at 0
+}
+
+static uint32_t prng_next()
+{
+	uint32_t x = prng_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return prng_state = x;
+}
+
+// same bit selection as getrandom_binary() applies to the hardware RNG word
+static void prng_binary(uint8_t* str)
+{
+	uint32_t tmp = prng_next();
+	for (int i = 0; i < 4; i++) {
+		str[i] = (uint8_t)((tmp >> 28) & 1);
+		tmp = tmp << 8;
+	}
+}
+
+#endif
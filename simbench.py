@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+#
+# Collects the "bench," CSV lines (firmware built with -DBENCH_ITERS=n) from
+# headless testbench logs, writes a results table and compares the median
+# cycle counts with a checked-in baseline. Used by "make hx8ksimbench".
+#
+#   ./simbench.py [--baseline F] [--threshold PCT] [--out F] log..
+#   ./simbench.py --write-baseline F log..
+#
+# Exits with 1 when a log has no results (boot failure, simulation timeout),
+# when an operation has no baseline entry (missing file included) or when it
+# got slower than the baseline by more than PCT percent. --baseline /dev/null
+# only writes the table.
+
+import argparse
+import os
+import sys
+
+FIELDS = ["cycles_min", "cycles_median", "cycles_mean", "cycles_max",
+          "instret_min", "instret_median", "instret_mean", "instret_max"]
+
+def parse_log(name):
+    results = list()
+    with open(name, errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("bench,") or line.startswith("bench,params"):
+                continue
+            v = line.split(",")
+            if len(v) != 5 + len(FIELDS):
+                continue
+            r = {"params": v[1], "backend": v[2], "op": v[3], "iters": int(v[4])}
+            for k, x in zip(FIELDS, v[5:]):
+                r[k] = int(x)
+            results.append(r)
+    return results
+
+def key(r):
+    return (r["params"], r["backend"], r["op"])
+
+def read_baseline(name):
+    baseline = dict()
+    try:
+        with open(name) as f:
+            for line in f:
+                line = line.strip()
+                if line == "" or line.startswith("#") or line.startswith("params,"):
+                    continue
+                v = line.split(",")
+                baseline[(v[0], v[1], v[2])] = int(v[3])
+    except FileNotFoundError:
+        pass
+    return baseline
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--baseline", default="simbench_baseline.csv")
+    ap.add_argument("--threshold", type=float, default=5.0)
+    ap.add_argument("--out", default="simbench.txt")
+    ap.add_argument("--write-baseline")
+    ap.add_argument("logs", nargs="+")
+    args = ap.parse_args()
+
+    results = list()
+    failed = False
+    for name in args.logs:
+        r = parse_log(name)
+        if not r:
+            print("%s: no benchmark results (boot failure or simulation timeout?)" % name)
+            failed = True
+        results += r
+
+    if args.write_baseline:
+        with open(args.write_baseline, "w") as f:
+            f.write("# median cycles per operation, regenerate with: make hx8ksimbench_baseline\n")
+            f.write("params,backend,op,cycles_median\n")
+            for r in results:
+                f.write("%s,%s,%s,%d\n" % (r["params"], r["backend"], r["op"], r["cycles_median"]))
+        print("wrote %s (%d operations)" % (args.write_baseline, len(results)))
+        return 1 if failed else 0
+
+    baseline = read_baseline(args.baseline)
+    compare = args.baseline != os.devnull
+    lines = ["%-10s %-10s %-8s %10s %10s %10s %10s %5s %10s %8s  %s" % ("params", "backend", "op",
+            "min", "median", "mean", "max", "CPI", "baseline", "change", "")]
+    for r in results:
+        base = baseline.get(key(r))
+        change, status = "", ""
+        if compare and not base:
+            status = "NO BASELINE"
+            failed = True
+        if base:
+            pct = 100.0 * (r["cycles_median"] - base) / base
+            change = "%+.1f%%" % pct
+            status = "ok"
+            if pct > args.threshold:
+                status = "REGRESSION"
+                failed = True
+        lines.append("%-10s %-10s %-8s %10d %10d %10d %10d %5.2f %10s %8s  %s" % (r["params"], r["backend"],
+                r["op"], r["cycles_min"], r["cycles_median"], r["cycles_mean"], r["cycles_max"],
+                r["cycles_median"] / max(r["instret_median"], 1), base if base else "-", change, status))
+
+    with open(args.out, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print("\n".join(lines))
+    if failed:
+        print("FAILED (threshold %.1f%%)" % args.threshold)
+        if compare and any(baseline.get(key(r)) is None for r in results):
+            print("%s: record the missing entries with make hx8ksimbench_baseline and commit them" % args.baseline)
+    return 1 if failed else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
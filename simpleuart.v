@@ -32,8 +32,22 @@ module simpleuart (
 	input         reg_dat_re,
 	input  [31:0] reg_dat_di,
 	output [31:0] reg_dat_do,
-	output        reg_dat_wait
+	output        reg_dat_wait,
+
+	input         reg_stat_we,
+	input  [31:0] reg_stat_di,
+	output [31:0] reg_stat_do,
+
+	output        irq
 );
+	// transmit FIFO in bytes, 0 or a power of two >= 2. With 0, a write to the
+	// data register waits until the previous byte has been shifted out; with a
+	// FIFO it only waits while the FIFO is full.
+	parameter integer TX_FIFO_DEPTH = 16;
+
+	localparam integer TX_FIFO_SIZE = TX_FIFO_DEPTH > 1 ? TX_FIFO_DEPTH : 2;
+	localparam integer TX_ABITS = $clog2(TX_FIFO_SIZE);
+
 	reg [31:0] cfg_divider;
 
 	reg [3:0] recv_state;
@@ -47,11 +61,44 @@ module simpleuart (
 	reg [31:0] send_divcnt;
 	reg send_dummy;
 
+	reg [7:0] tx_fifo [0:TX_FIFO_SIZE-1];
+	reg [TX_ABITS:0] tx_wptr;
+	reg [TX_ABITS:0] tx_rptr;
+	reg tx_irq_en;
+
+	wire [TX_ABITS:0] tx_level = TX_FIFO_DEPTH ? tx_wptr - tx_rptr : 0;
+	wire tx_busy = send_bitcnt || send_dummy;
+	wire tx_full = TX_FIFO_DEPTH ? tx_level == TX_FIFO_DEPTH : tx_busy;
+	wire tx_valid = TX_FIFO_DEPTH ? tx_level != 0 : reg_dat_we;
+	wire [7:0] tx_data = TX_FIFO_DEPTH ? tx_fifo[tx_rptr[TX_ABITS-1:0]] : reg_dat_di[7:0];
+	wire [7:0] tx_level_do = tx_level;
+	wire [7:0] tx_depth_do = TX_FIFO_DEPTH;
+
 	assign reg_div_do = cfg_divider;
 
-	assign reg_dat_wait = reg_dat_we && (send_bitcnt || send_dummy);
+	assign reg_dat_wait = reg_dat_we && tx_full;
 	assign reg_dat_do = recv_buf_valid ? recv_buf_data : ~0;
 
+	// status register: bit 0 TX IRQ enable (read/write), bit 1 TX empty (FIFO
+	// empty and nothing being shifted out), bit 2 TX FIFO full, bit 3 RX byte
+	// valid, bits 15:8 TX FIFO level, bits 23:16 TX_FIFO_DEPTH
+	assign reg_stat_do = {8'd 0, tx_depth_do, tx_level_do, 4'd 0, recv_buf_valid, tx_full, !tx_level && !tx_busy, tx_irq_en};
+
+	// TX IRQ while enabled and the FIFO is at most half full (no FIFO: idle)
+	assign irq = tx_irq_en && (TX_FIFO_DEPTH ? tx_level <= TX_FIFO_DEPTH / 2 : !tx_busy);
+
+	always @(posedge clk) begin
+		if (!resetn)
+			tx_irq_en <= 0;
+		else if (reg_stat_we)
+			tx_irq_en <= reg_stat_di[0];
+	end
+
+	always @(posedge clk) begin
+		if (TX_FIFO_DEPTH && reg_dat_we && !tx_full)
+			tx_fifo[tx_wptr[TX_ABITS-1:0]] <= reg_dat_di[7:0];
+	end
+
 	always @(posedge clk) begin
 		if (!resetn) begin
 			cfg_divider <= 1;
@@ -115,17 +162,23 @@ module simpleuart (
 			send_bitcnt <= 0;
 			send_divcnt <= 0;
 			send_dummy <= 1;
+			tx_wptr <= 0;
+			tx_rptr <= 0;
 		end else begin
+			if (TX_FIFO_DEPTH && reg_dat_we && !tx_full)
+				tx_wptr <= tx_wptr + 1;
 			if (send_dummy && !send_bitcnt) begin
 				send_pattern <= ~0;
 				send_bitcnt <= 15;
 				send_divcnt <= 0;
 				send_dummy <= 0;
 			end else
-			if (reg_dat_we && !send_bitcnt) begin
-				send_pattern <= {1'b1, reg_dat_di[7:0], 1'b0};
+			if (tx_valid && !send_bitcnt) begin
+				send_pattern <= {1'b1, tx_data, 1'b0};
 				send_bitcnt <= 10;
 				send_divcnt <= 0;
+				if (TX_FIFO_DEPTH)
+					tx_rptr <= tx_rptr + 1;
 			end else
 			if (send_divcnt > cfg_divider && send_bitcnt) begin
 				send_pattern <= {1'b1, send_pattern[9:1]};
@@ -577,3 +577,146 @@ module spimemio_xfer (
 		end
 	end
 endmodule
+
+// Direct-mapped read cache between the CPU bus and spimemio.
+//
+// CACHE_BYTES must be a power of two (256 .. 1024 fit one or two iCE40 BRAMs),
+// CACHE_BYTES = 0 removes the cache and passes the bus straight through.
+// Lines are 16 bytes and are filled with four sequential spimemio reads, which
+// keeps spimemio in its continuous read mode for the whole line. A hit returns
+// data one cycle after valid, like the internal SRAM.
+//
+// Flash can only change while MEMIO is disabled (bit bang mode), which always
+// goes through a write to the config register, so flush is pulsed on every
+// config register write. This also gives the flash mode calibration a cold
+// cache for every mode it measures.
+
+module spimemio_cache #(
+	parameter integer CACHE_BYTES = 512
+) (
+	input clk, resetn,
+	input flush,
+
+	input valid,
+	output ready,
+	input [23:0] addr,
+	output [31:0] rdata,
+
+	output mem_valid,
+	input mem_ready,
+	output [23:0] mem_addr,
+	input [31:0] mem_rdata,
+
+	input counters_reset,
+	output [31:0] hit_count,
+	output [31:0] miss_count
+);
+	generate if (CACHE_BYTES == 0) begin: passthru
+		assign mem_valid = valid;
+		assign mem_addr = addr;
+		assign ready = mem_ready;
+		assign rdata = mem_rdata;
+		assign hit_count = 0;
+		assign miss_count = 0;
+	end else begin: cache
+		localparam integer LINE_WORDS = 4;
+		localparam integer LINES = CACHE_BYTES / (4*LINE_WORDS);
+		localparam integer INDEX_BITS = $clog2(LINES);
+		localparam integer TAG_BITS = 22 - INDEX_BITS - 2;
+
+		reg [31:0] data_mem [0:LINES*LINE_WORDS-1];
+		reg [TAG_BITS-1:0] tag_mem [0:LINES-1];
+		reg [LINES-1:0] line_valid;
+
+		wire [1:0]            req_word  = addr[3:2];
+		wire [INDEX_BITS-1:0] req_index = addr[4 +: INDEX_BITS];
+		wire [TAG_BITS-1:0]   req_tag   = addr[23 -: TAG_BITS];
+
+		reg [31:0] data_q;
+		reg [TAG_BITS-1:0] tag_q;
+
+		reg [1:0] state;
+		reg [1:0] fill_word;
+		reg [31:0] fill_data;
+		reg fill_valid;
+		reg [31:0] hits, misses;
+
+		localparam [1:0] S_IDLE = 0, S_LOOKUP = 1, S_FILL = 2, S_DONE = 3;
+
+		wire hit = line_valid[req_index] && (tag_q == req_tag);
+
+		assign ready = valid && ((state == S_LOOKUP && hit) || state == S_DONE);
+		assign rdata = (state == S_DONE) ? fill_data : data_q;
+
+		assign mem_valid = fill_valid;
+		assign mem_addr = {req_tag, req_index, fill_word, 2'b 00};
+
+		assign hit_count = hits;
+		assign miss_count = misses;
+
+		// read ports (BRAM, registered)
+		always @(posedge clk) begin
+			data_q <= data_mem[{req_index, req_word}];
+			tag_q <= tag_mem[req_index];
+		end
+
+		// write ports
+		always @(posedge clk) begin
+			if (state == S_FILL && mem_ready)
+				data_mem[{req_index, fill_word}] <= mem_rdata;
+			if (state == S_FILL && mem_ready && fill_word == LINE_WORDS-1)
+				tag_mem[req_index] <= req_tag;
+		end
+
+		always @(posedge clk) begin
+			if (!resetn) begin
+				state <= S_IDLE;
+				fill_valid <= 0;
+				line_valid <= 0;
+				hits <= 0;
+				misses <= 0;
+			end else begin
+				case (state)
+					S_IDLE: begin
+						if (valid)
+							state <= S_LOOKUP;
+					end
+					S_LOOKUP: begin
+						if (hit) begin
+							hits <= hits + 1;
+							state <= S_IDLE;
+						end else begin
+							misses <= misses + 1;
+							fill_word <= 0;
+							fill_valid <= 1;
+							state <= S_FILL;
+						end
+					end
+					S_FILL: begin
+						if (mem_ready) begin
+							if (fill_word == req_word)
+								fill_data <= mem_rdata;
+							fill_word <= fill_word + 1;
+							if (fill_word == LINE_WORDS-1) begin
+								fill_valid <= 0;
+								line_valid[req_index] <= 1;
+								state <= S_DONE;
+							end
+						end
+					end
+					S_DONE: begin
+						state <= S_IDLE;
+					end
+				endcase
+
+				if (counters_reset) begin
+					hits <= 0;
+					misses <= 0;
+				end
+
+				if (flush)
+					line_valid <= 0;
+			end
+		end
+	end endgenerate
+endmodule
@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include "stack.h"
+
+#if defined(STACK_PAINT_EN) && (STACK_PAINT_EN == 1)
+
+extern uint32_t _stack_bottom;
+extern uint32_t _stack_top;
+
+#define STACK_PAINT_MARGIN 64 // bytes below sp left alone: stack_paint()'s own callees
+
+/*************************************************
+* Name:        stack_paint
+* 
+* Description: Fill the stack from its bottom (end of the heap) up to
+*              STACK_PAINT_MARGIN bytes below the current stack pointer
+*              with STACK_CANARY
+**************************************************/
+void stack_paint()
+{
+	uint32_t sp;
+	__asm__ volatile ("mv %0, sp" : "=r"(sp));
+
+	volatile uint32_t* p = &_stack_bottom;
+	volatile uint32_t* end = (uint32_t*)((sp - STACK_PAINT_MARGIN) & ~3u);
+	while (p < end)
+		*p++ = STACK_CANARY;
+}
+
+uint32_t stack_used()
+{
+	volatile uint32_t* p = &_stack_bottom;
+	while (p < &_stack_top && *p == STACK_CANARY)
+		p++;
+	return (uint32_t)&_stack_top - (uint32_t)p;
+}
+
+uint32_t stack_size()
+{
+	return (uint32_t)&_stack_top - (uint32_t)&_stack_bottom;
+}
+
+int stack_overflow()
+{
+	return *(volatile uint32_t*)&_stack_bottom != STACK_CANARY;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef _STACK_H_
+#define _STACK_H_
+
+#include <stdint.h>
+#include "params.h"
+
+// Stack depth measurement by painting. stack_paint() fills the free part of the
+// stack (between the end of the heap and the current stack pointer) with
+// STACK_CANARY; after the measured section stack_used() finds the lowest word
+// that was overwritten. The stack limits come from sections.lds. With
+// STACK_PAINT_EN = 0 the calls compile to nothing.
+
+#define STACK_CANARY 0x5354434bu // "STCK"
+
+#if defined(STACK_PAINT_EN) && (STACK_PAINT_EN == 1)
+
+void stack_paint();
+uint32_t stack_used();   // deepest stack use in bytes since stack_paint(), from the top of the stack
+uint32_t stack_size();   // bytes between the end of the heap and the top of the stack
+int stack_overflow();    // 1 when the word above the heap end was overwritten
+void stack_print();      // firmware.c
+
+#else
+
+#define stack_paint() do { } while (0)
+#define stack_print() do { } while (0)
+
+#endif
+
+#endif
@@ -65,6 +65,19 @@ addi a1, a1, 4
 blt a1, a2, loop_init_data
 end_init_data:
 
+# copy ramfunc section (hot code and fastdata tables)
+la a0, _siramfunc
+la a1, _sramfunc
+la a2, _eramfunc
+bge a1, a2, end_init_ramfunc
+loop_init_ramfunc:
+lw a3, 0(a0)
+sw a3, 0(a1)
+addi a0, a0, 4
+addi a1, a1, 4
+blt a1, a2, loop_init_ramfunc
+end_init_ramfunc:
+
 # Update LEDs
 li a0, 0x03000000
 li a1, 7
@@ -99,6 +112,7 @@ flashio_worker_begin:
 # a0 ... data pointer
 # a1 ... data length
 # a2 ... optional WREN cmd (0 = disable)
+# a3 ... wait for the flash to finish (poll RDSR1 WIP) before returning (0 = disable)
 
 # address of SPI ctrl reg
 li   t0, 0x02000000
@@ -149,6 +163,30 @@ addi a1, a1, -1
 j    flashio_worker_L1
 flashio_worker_L3:
 
+# Optional busy wait (erase/program): the flash can not be read
+# by MEMIO until WIP is cleared, so this must run from RAM
+beqz a3, flashio_worker_L7
+flashio_worker_L5:
+sb   t1, 0(t0)
+li   t2, 0x0500
+li   t5, 16
+flashio_worker_L6:
+srli t4, t2, 15
+andi t4, t4, 1
+sb   t4, 0(t0)
+ori  t4, t4, 0x10
+sb   t4, 0(t0)
+lbu  t4, 0(t0)
+andi t4, t4, 2
+srli t4, t4, 1
+slli t2, t2, 1
+or   t2, t2, t4
+addi t5, t5, -1
+bnez t5, flashio_worker_L6
+andi t2, t2, 1
+bnez t2, flashio_worker_L5
+flashio_worker_L7:
+
 # Back to MEMIO mode
 li   t1, 0x80
 sb   t1, 3(t0)
@@ -158,6 +196,109 @@ ret
 .balign 4
 flashio_worker_end:
 
+.global flashcal_worker_begin
+.global flashcal_worker_end
+
+.balign 4
+
+flashcal_worker_begin:
+# a0 ... SPI ctrl reg bits 23:16 (DDR/QSPI/CRM/dummy) to test
+# a1 ... word pointer to the memory mapped flash area to read
+# a2 ... number of words to read (> 0)
+# a3 ... result pointer: [0] checksum, [1] cycles
+# a4 ... SPI ctrl reg bits 23:16 to restore afterwards
+
+# address of SPI ctrl reg
+li   t0, 0x02000000
+
+# Switch to the mode under test
+sb   a0, 2(t0)
+
+rdcycle t3
+li   t1, 0
+flashcal_worker_L1:
+lw   t2, 0(a1)
+slli t4, t1, 5
+srli t5, t1, 27
+or   t1, t4, t5
+add  t1, t1, t2
+addi a1, a1, 4
+addi a2, a2, -1
+bnez a2, flashcal_worker_L1
+rdcycle t4
+sub  t4, t4, t3
+
+# Back to the known good mode
+sb   a4, 2(t0)
+
+sw   t1, 0(a3)
+sw   t4, 4(a3)
+ret
+
+.balign 4
+flashcal_worker_end:
+
+/* IRQ entry
+ **********************************/
+# picorv32 jumps to PROGADDR_IRQ = 0 (start of SRAM) with the return address
+# in x3 (gp) and the pending IRQ bits in x4 (tp), as picosoc has no
+# ENABLE_IRQ_QREGS. sections.lds puts .irqvec at RAM address 0 (copied with
+# .data), so only this stub takes SRAM; it saves one scratch register and
+# jumps to irq_entry in flash.
+.section .irqvec, "ax"
+irq_vec:
+	addi sp, sp, -64
+	sw   t0, 0(sp)
+	lui  t0, %hi(irq_entry)
+	jalr zero, %lo(irq_entry)(t0)
+
+.section .text
+
+# save the caller-saved registers, call irq_handler(irqs) in firmware.c
+irq_entry:
+	sw   ra, 4(sp)
+	sw   t1, 8(sp)
+	sw   t2, 12(sp)
+	sw   a0, 16(sp)
+	sw   a1, 20(sp)
+	sw   a2, 24(sp)
+	sw   a3, 28(sp)
+	sw   a4, 32(sp)
+	sw   a5, 36(sp)
+	sw   a6, 40(sp)
+	sw   a7, 44(sp)
+	sw   t3, 48(sp)
+	sw   t4, 52(sp)
+	sw   t5, 56(sp)
+	sw   t6, 60(sp)
+	mv   a0, tp
+	call irq_handler
+	lw   ra, 4(sp)
+	lw   t1, 8(sp)
+	lw   t2, 12(sp)
+	lw   a0, 16(sp)
+	lw   a1, 20(sp)
+	lw   a2, 24(sp)
+	lw   a3, 28(sp)
+	lw   a4, 32(sp)
+	lw   a5, 36(sp)
+	lw   a6, 40(sp)
+	lw   a7, 44(sp)
+	lw   t3, 48(sp)
+	lw   t4, 52(sp)
+	lw   t5, 56(sp)
+	lw   t6, 60(sp)
+	lw   t0, 0(sp)
+	addi sp, sp, 64
+	.word 0x0400000b # retirq: jump to x3
+
+# uint32_t irq_setmask(uint32_t mask): set the picorv32 IRQ mask (1 = masked,
+# all masked after reset), returns the old one
+.global irq_setmask
+irq_setmask:
+	.word 0x0605650b # maskirq a0, a0
+	ret
+
 /* Hard mul functions for brlwe.c
  **********************************/
 hard_mul:
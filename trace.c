@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include "trace.h"
+
+#if defined(TRACE_EN) && (TRACE_EN == 1)
+
+#if (TRACE_DEPTH & (TRACE_DEPTH - 1)) != 0
+#  error "TRACE_DEPTH must be a power of two"
+#endif
+
+static struct trace_entry trace_buf[TRACE_DEPTH];
+static uint32_t trace_head;  // next slot to write
+static uint32_t trace_count; // entries written since trace_reset()
+
+static struct trace_stats trace_acc[TRACE_EVENTS];
+static uint32_t trace_open_cycle[TRACE_EVENTS];   // rdcycle at the last entry of each id
+static uint32_t trace_open_instret[TRACE_EVENTS];
+
+/*************************************************
+* Name:        trace_record
+* 
+* Description: Append one entry with the current 64-bit cycle counter and
+*              retired instruction counter, overwriting the oldest entry
+*              when the buffer is full, and add the call to the accumulator
+*              of its id at the end of a function. Kernel ids only update
+*              the accumulator.
+*
+* Arguments:   - uint32_t event: trace_event id, or'ed with TRACE_END at the end of a function
+**************************************************/
+RAMFUNC void trace_record(uint32_t event)
+{
+	uint32_t hi, lo, hi2, instret;
+	do {
+		__asm__ volatile ("rdcycleh %0" : "=r"(hi));
+		__asm__ volatile ("rdcycle %0" : "=r"(lo));
+		__asm__ volatile ("rdinstret %0" : "=r"(instret));
+		__asm__ volatile ("rdcycleh %0" : "=r"(hi2));
+	} while (hi != hi2);
+
+	uint32_t id = event & ~TRACE_END;
+	if (id < TRACE_EVENTS) {
+		if (event & TRACE_END) {
+			trace_acc[id].calls++;
+			trace_acc[id].cycles += lo - trace_open_cycle[id];
+			trace_acc[id].instret += instret - trace_open_instret[id];
+		} else {
+			trace_open_cycle[id] = lo;
+			trace_open_instret[id] = instret;
+		}
+		if (id >= TRACE_KERNEL_FIRST)
+			return;
+	}
+
+	struct trace_entry* e = &trace_buf[trace_head];
+	e->event = event;
+	e->cycle_lo = lo;
+	e->cycle_hi = hi;
+	e->instret = instret;
+	trace_head = (trace_head + 1) & (TRACE_DEPTH - 1);
+	trace_count++;
+}
+
+void trace_reset()
+{
+	trace_head = 0;
+	trace_count = 0;
+	for (int i = 0; i < TRACE_EVENTS; i++) {
+		trace_acc[i].calls = 0;
+		trace_acc[i].cycles = 0;
+		trace_acc[i].instret = 0;
+	}
+}
+
+int trace_get(int n, struct trace_entry* e)
+{
+	uint32_t valid = trace_count < TRACE_DEPTH ? trace_count : TRACE_DEPTH;
+	if (n < 0 || (uint32_t)n >= valid)
+		return 0;
+	*e = trace_buf[(trace_head - valid + n) & (TRACE_DEPTH - 1)];
+	return 1;
+}
+
+uint32_t trace_lost()
+{
+	return trace_count > TRACE_DEPTH ? trace_count - TRACE_DEPTH : 0;
+}
+
+int trace_stats_get(uint32_t event, struct trace_stats* s)
+{
+	if (event == 0 || event >= TRACE_EVENTS)
+		return 0;
+	*s = trace_acc[event];
+	return 1;
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include "params.h"
+
+// Trace points of the BRLWE library. TRACE(id) marks the start of a function,
+// TRACE(id | TRACE_END) its end. Entries go to a ring buffer in RAM and are
+// printed by trace_dump() (firmware.c) after the measured section, so no UART
+// output happens inside it. With TRACE_EN = 0 the trace points compile to nothing.
+//
+// Every id also has an accumulator (calls, cycles, retired instructions) read
+// with trace_stats_get() and printed by trace_stats_dump(). Kernel ids from
+// TRACE_KERNEL_FIRST on are called many times per operation, so they only
+// update their accumulator and stay out of the ring buffer.
+
+enum trace_event {
+	TRACE_INIT_BIN_SAMPLING = 1,
+	TRACE_INIT_HEX,
+	TRACE_INIT,
+	TRACE_RING_ADD,
+	TRACE_RING_SUB,
+	TRACE_RING_MUL,
+	TRACE_NTT_64,     // ntt.c: ntt_64 and invntt_64, forward and inverse butterflies
+	TRACE_INVNTT_64,  // ntt.c: poly_invntt_64 (including its invntt_64)
+	TRACE_BOWTIE,     // ntt.c: pt_ntt_bowtiemultiply
+	TRACE_NTT_PT,     // ntt.c: ntt_pt and invntt_pt (PTNTT_SPLIT 4 and 8)
+	TRACE_PT_BASEMUL, // ntt.c: pt_ntt_basemul2/4/8
+	TRACE_DECODE,     // brlwe.c: BRLWE_Decode
+	TRACE_DECRY_KERNEL, // brlwe.c: BRLWE_Decry_kernel (8-bit path: multiply, add and decode fused)
+	TRACE_EVENTS,
+	TRACE_KERNEL_FIRST = TRACE_NTT_64
+};
+
+#define TRACE_END 0x80
+
+struct trace_entry {
+	uint32_t event;
+	uint32_t cycle_lo; // rdcycle
+	uint32_t cycle_hi; // rdcycleh
+	uint32_t instret;  // rdinstret
+};
+
+struct trace_stats {
+	uint32_t calls;   // completed calls
+	uint32_t cycles;  // sum of the cycles between entry and exit
+	uint32_t instret; // sum of the retired instructions between entry and exit
+};
+
+#if defined(TRACE_EN) && (TRACE_EN == 1)
+
+#define TRACE(event) trace_record(event)
+
+void trace_record(uint32_t event);
+void trace_reset();
+int trace_get(int n, struct trace_entry* e); // n-th oldest entry, 0 when n is out of range
+uint32_t trace_lost();                       // entries overwritten since the last trace_reset()
+int trace_stats_get(uint32_t event, struct trace_stats* s); // accumulator of one id, 0 when event is out of range
+void trace_dump();                           // firmware.c
+void trace_stats_dump();                     // firmware.c
+
+#else
+
+#define TRACE(event) do { } while (0)
+#define trace_reset() do { } while (0)
+#define trace_dump() do { } while (0)
+#define trace_stats_dump() do { } while (0)
+
+#endif
+
+#endif